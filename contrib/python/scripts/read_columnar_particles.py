@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+""" Read particle output files that ASPECT writes in the 'columnar' format.
+
+A file starts with a text header of lines of the form 'key: value', followed
+by one line 'type name' per column, where type is 'uint64' or 'float64', and
+is terminated by the line 'end of header'. After the header follows an index
+with one row of (number of columns + 1) unsigned 64 bit integers per block:
+the number of particles in the block, and then the size in bytes of each of
+its columns. The blocks (one per process that wrote the file) follow the
+index in the same order, and each block contains its columns one after the
+other. If the header says 'compression: zlib', every column of every block
+is compressed separately with zlib. All binary values use the byte order
+given in the header.
+
+This script only uses the python standard library. Called from the command
+line with the name of a file, it prints the header information and then all
+particles sorted by id.
+"""
+
+import struct
+import sys
+import zlib
+
+__author__ = 'The authors of the ASPECT code'
+__copyright__ = 'Copyright 2026, ASPECT'
+__license__ = 'GNU GPL 2 or later'
+
+
+
+def read_columnar_particles(fname):
+    """ Read a particle output file in the 'columnar' format.
+
+    Return a dictionary with the values of the header, a list of the names
+    of the columns, and a dictionary that maps each column name to the list
+    of values of all particles in the file.
+    """
+    header = {}
+    column_names = []
+    column_types = []
+
+    with open(fname, 'rb') as f:
+        first_line = f.readline().decode('utf-8').rstrip('\n')
+        if first_line != 'ASPECT columnar particle output':
+            raise ValueError(fname + ' is not a columnar particle output file.')
+
+        while True:
+            line = f.readline()
+            if not line:
+                raise ValueError('The header of ' + fname + ' is not terminated.')
+            line = line.decode('utf-8').rstrip('\n')
+            if line == 'end of header':
+                break
+
+            if line.startswith('uint64 ') or line.startswith('float64 '):
+                column_type, name = line.split(' ', 1)
+                column_types.append(column_type)
+                column_names.append(name)
+            else:
+                key, value = line.split(': ', 1)
+                header[key] = value
+
+        if header['version'] != '1':
+            raise ValueError('Unsupported version ' + header['version'] + ' of the columnar format.')
+
+        byte_order = '<' if header['byte order'] == 'little endian' else '>'
+        compressed = (header['compression'] == 'zlib')
+        n_blocks = int(header['number of blocks'])
+        n_columns = int(header['number of columns'])
+        assert n_columns == len(column_names)
+
+        row_size = n_columns + 1
+        index_data = f.read(8 * n_blocks * row_size)
+        index = struct.unpack(byte_order + str(n_blocks * row_size) + 'Q', index_data)
+
+        data = {name: [] for name in column_names}
+        for block in range(n_blocks):
+            row = index[block * row_size:(block + 1) * row_size]
+            n_particles = row[0]
+            for c in range(n_columns):
+                column_bytes = f.read(row[c + 1])
+                if compressed:
+                    column_bytes = zlib.decompress(column_bytes)
+
+                value_type = 'Q' if column_types[c] == 'uint64' else 'd'
+                data[column_names[c]].extend(struct.unpack(byte_order + str(n_particles) + value_type,
+                                                           column_bytes))
+
+    return header, column_names, data
+
+
+
+def main():
+    if len(sys.argv) != 2:
+        print('Usage: ' + sys.argv[0] + ' <particle output file>')
+        sys.exit(1)
+
+    header, column_names, data = read_columnar_particles(sys.argv[1])
+
+    for key in ['dimension', 'time', 'timestep', 'number of particles', 'compression']:
+        print(key + ': ' + header[key])
+    print('columns: ' + ', '.join(column_names))
+
+    order = sorted(range(len(data['id'])), key=lambda i: data['id'][i])
+    for i in order:
+        print(' '.join('%g' % data[name][i] for name in column_names))
+
+
+
+if __name__ == '__main__':
+    main()
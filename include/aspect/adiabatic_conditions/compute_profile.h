@@ -24,6 +24,7 @@
 
 
 #include <aspect/adiabatic_conditions/interface.h>
+#include <aspect/material_model/interface.h>
 
 #include <deal.II/base/parsed_function.h>
 
@@ -63,7 +64,8 @@ namespace aspect
         /**
          * Update function. By default does nothing, but if a time-dependent
          * surface condition function is used, this will reinitialize the
-         * adiabatic profile with the current conditions.
+         * adiabatic profile with the current conditions, unless they are
+         * the same as the ones the current profile was computed for.
          */
         void update () override;
 
@@ -128,6 +130,27 @@ namespace aspect
          */
         unsigned int n_points;
 
+        /**
+         * An enum describing the different methods to integrate the
+         * hydrostatic equations in depth.
+         */
+        enum IntegrationScheme
+        {
+          explicit_euler,
+          runge_kutta_4
+        };
+
+        /**
+         * Selected method to integrate the hydrostatic equations.
+         */
+        IntegrationScheme integration_scheme;
+
+        /**
+         * Number of steps of the Runge-Kutta integration. Only used if the
+         * integration_scheme is runge_kutta_4.
+         */
+        unsigned int n_integration_steps;
+
         /**
          * Vectors of values of temperatures and pressures on a transect into
          * depth at which we have computed them. The public member functions
@@ -168,7 +191,7 @@ namespace aspect
          * Whether to use the surface_conditions_function to determine surface
          * conditions, or the adiabatic_surface_temperature and surface_pressure
          * parameters. If this is set to true the reference profile is updated
-         * every timestep.
+         * every timestep in which the surface conditions have changed.
          */
         bool use_surface_condition_function;
 
@@ -186,6 +209,32 @@ namespace aspect
          */
         std::shared_ptr<const aspect::InitialComposition::Manager<dim>> initial_composition_manager;
 
+        /**
+         * Internal helper function. Set the reference composition of the
+         * evaluation point @p q of @p in, based on its position.
+         */
+        void set_reference_composition (MaterialModel::MaterialModelInputs<dim> &in,
+                                        const unsigned int q) const;
+
+        /**
+         * Internal helper function. Compute the tables of pressures,
+         * temperatures and densities, given the surface values in the first
+         * entries, by integrating the hydrostatic equations with the
+         * explicit Euler method on the points of the tables.
+         */
+        void integrate_explicit_euler (const int gravity_direction);
+
+        /**
+         * Internal helper function. Compute the tables of pressures,
+         * temperatures and densities, given the surface values in the first
+         * entries, by integrating the hydrostatic equations with the
+         * classical fourth order Runge-Kutta method on a coarser grid, and
+         * interpolating the result to the points of the tables. The
+         * densities at these points are then computed by all processes
+         * together.
+         */
+        void integrate_runge_kutta (const int gravity_direction);
+
         /**
          * Internal helper function. Returns the reference property at a
          * given point of the domain.
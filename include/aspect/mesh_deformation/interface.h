@@ -528,6 +528,30 @@ namespace aspect
          */
         AffineConstraints<double> mesh_vertex_constraints;
 
+        /**
+         * The matrix of the vector Laplace problem that is solved for the
+         * mesh velocity. Its sparsity pattern only depends on the degrees of
+         * freedom and on which of them are constrained, so the matrix is
+         * kept between time steps and its sparsity pattern is only
+         * rebuilt if one of these changes.
+         */
+        LinearAlgebra::SparseMatrix mesh_matrix;
+
+        /**
+         * A copy of the constraints that were used to build the sparsity
+         * pattern of the mesh_matrix. Only the structure of these
+         * constraints is of interest, not their values.
+         */
+        AffineConstraints<double> mesh_matrix_constraints;
+
+        /**
+         * The AMG preconditioner for the mesh_matrix. As long as the sparsity
+         * pattern of the matrix does not change, the aggregation of the AMG
+         * hierarchy is kept, and only the level operators and smoothers
+         * are recomputed for the new matrix entries.
+         */
+        std::unique_ptr<LinearAlgebra::PreconditionAMG> mesh_preconditioner;
+
         /**
          * A map of boundary ids to mesh deformation objects that have been requested
          * in the parameter file.
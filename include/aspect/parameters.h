@@ -313,6 +313,80 @@ namespace aspect
       }
     };
 
+    /**
+     * This enum represents the different choices for the time integration
+     * of reactions when operator splitting is used. See
+     * @p reaction_solver_type.
+     */
+    struct ReactionSolverType
+    {
+      enum Kind
+      {
+        fixed_step,
+        adaptive_step
+      };
+
+      /**
+       * This function translates an input string into the
+       * available enum options.
+       */
+      static
+      Kind
+      parse(const std::string &input)
+      {
+        if (input == "fixed step")
+          return fixed_step;
+        else if (input == "adaptive step")
+          return adaptive_step;
+        else
+          AssertThrow(false, ExcNotImplemented());
+
+        return Kind();
+      }
+
+      static std::string get_options_string()
+      {
+        return "fixed step|adaptive step";
+      }
+    };
+
+    /**
+     * This enum represents the different policies for deciding when the
+     * matrix-based Stokes preconditioner is rebuilt. See
+     * @p stokes_preconditioner_rebuild_policy.
+     */
+    struct StokesPreconditionerRebuildPolicy
+    {
+      enum Kind
+      {
+        always,
+        adaptive
+      };
+
+      /**
+       * This function translates an input string into the
+       * available enum options.
+       */
+      static
+      Kind
+      parse(const std::string &input)
+      {
+        if (input == "always")
+          return always;
+        else if (input == "adaptive")
+          return adaptive;
+        else
+          AssertThrow(false, ExcNotImplemented());
+
+        return Kind();
+      }
+
+      static std::string get_options_string()
+      {
+        return "always|adaptive";
+      }
+    };
+
     /**
      * This enum represents the different choices for the linear solver
      * for the Stoke system. See @p stokes_solver_type.
@@ -453,10 +527,12 @@ namespace aspect
 
     typename AdvectionStabilizationMethod::Kind advection_stabilization_method;
     double                         nonlinear_tolerance;
+    unsigned int                   nonlinear_solver_acceleration_depth;
     bool                           resume_computation;
     double                         start_time;
     double                         end_time;
     double                         CFL_number;
+    unsigned int                   maximum_advection_subcycling_level;
     double                         maximum_time_step;
     double                         maximum_relative_increase_time_step;
     double                         maximum_first_time_step;
@@ -499,16 +575,24 @@ namespace aspect
     bool                           use_full_A_block_preconditioner;
     double                         linear_solver_S_block_tolerance;
     unsigned int                   stokes_gmres_restart_length;
+    typename StokesPreconditionerRebuildPolicy::Kind stokes_preconditioner_rebuild_policy;
+    double                         stokes_preconditioner_iteration_growth;
+    double                         stokes_preconditioner_viscosity_change;
+    unsigned int                   stokes_preconditioner_max_reuses;
 
     // subsection: AMG parameters
     std::string                    AMG_smoother_type;
     unsigned int                   AMG_smoother_sweeps;
     double                         AMG_aggregation_threshold;
     bool                           AMG_output_details;
+    bool                           AMG_reuse_aggregation;
 
     // subsection: Operator splitting parameters
     double                         reaction_time_step;
     unsigned int                   reaction_steps_per_advection_step;
+    typename ReactionSolverType::Kind reaction_solver_type;
+    double                         reaction_relative_tolerance;
+    double                         reaction_absolute_tolerance;
 
     // subsection: Diffusion solver parameters
     double                         diffusion_length_scale;
@@ -636,6 +720,7 @@ namespace aspect
      */
     int                            checkpoint_time_secs;
     int                            checkpoint_steps;
+    bool                           write_checkpoint_in_background_thread;
     /**
      * @}
      */
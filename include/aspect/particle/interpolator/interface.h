@@ -30,6 +30,7 @@
 #include <deal.II/base/parameter_handler.h>
 #include <deal.II/distributed/tria.h>
 #include <deal.II/fe/component_mask.h>
+#include <deal.II/fe/mapping.h>
 
 namespace aspect
 {
@@ -134,6 +135,23 @@ namespace aspect
       };
 
 
+      /**
+       * Map all of the given @p positions into the reference coordinates of
+       * @p cell at once. This is faster than calling
+       * Mapping::transform_real_to_unit_cell() for each position individually,
+       * and interpolators should compute these coordinates only once per call,
+       * rather than once for every property they interpolate.
+       *
+       * If the mapping fails to invert any of the positions, an exception
+       * is thrown, as is done by Mapping::transform_real_to_unit_cell().
+       */
+      template <int dim>
+      std::vector<Point<dim>>
+      get_unit_positions (const Mapping<dim> &mapping,
+                          const typename parallel::distributed::Triangulation<dim>::active_cell_iterator &cell,
+                          const std::vector<Point<dim>> &positions);
+
+
       /**
        * Return a list of names (separated by '|') of possible interpolator
        * classes for particles.
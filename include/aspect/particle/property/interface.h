@@ -419,6 +419,15 @@ namespace aspect
            * which is the default. This option saves considerable computation
            * time in cases, when no plugin needs to update particle properties
            * over time.
+           *
+           * The Manager class calls this function only once, in
+           * Manager::initialize() after the initialize() function of this
+           * plugin, and caches the result. The returned value must
+           * therefore not change over the course of a model run, and must
+           * not depend on state that is only available later. In
+           * particular, if this function returns update_never, the
+           * update_particle_property() and update_one_particle_property()
+           * functions of this plugin are never called.
            */
           virtual
           UpdateTimeFlags
@@ -430,6 +439,10 @@ namespace aspect
            * (no data), update_values (solution values), and update_gradients
            * (solution gradients). All other update flags will have no effect.
            *
+           * Like need_update(), this function is only called once in
+           * Manager::initialize(), and its result must not change over the
+           * course of a model run.
+           *
            * @return The necessary update flags for this particle property.
            */
           virtual
@@ -597,7 +610,10 @@ namespace aspect
 
           /**
            * Update function for particle properties. This function is
-           * called once every time step for every particle.
+           * called once every time step for every particle. Only the
+           * plugins whose need_update() function does not return
+           * update_never are asked to update their part of the particle
+           * properties.
            */
           void
           update_one_particle (typename ParticleHandler<dim>::particle_iterator &particle,
@@ -787,6 +803,25 @@ namespace aspect
            * their association with property plugins and their storage pattern.
            */
           ParticlePropertyInformation property_information;
+
+          /**
+           * The property plugins that need to update their properties, i.e.
+           * whose need_update() function does not return update_never,
+           * together with the position of their first property component
+           * in the property array of each particle. This list is computed
+           * in initialize() so that update_one_particle() does not need to
+           * look up this information for every particle.
+           */
+          std::vector<std::pair<const Interface<dim> *, unsigned int>> plugins_to_update;
+
+          /**
+           * The combined result of need_update() and
+           * get_needed_update_flags() of all plugins. Both are computed
+           * in initialize(), since they are queried once per cell when
+           * updating the particles.
+           */
+          UpdateTimeFlags combined_update_time;
+          UpdateFlags combined_update_flags;
       };
 
       /* -------------------------- inline and template functions ---------------------- */
@@ -39,6 +39,7 @@
 
 #include <deal.II/base/timer.h>
 #include <deal.II/base/array_view.h>
+#include <deal.II/grid/grid_tools_cache.h>
 
 #include <boost/serialization/unique_ptr.hpp>
 
@@ -212,6 +213,30 @@ namespace aspect
          */
         types::particle_index n_global_particles() const;
 
+        /**
+         * Return the weight associated with the computational load of a
+         * single particle, relative to the weight of a cell without particles,
+         * which is defined to be 1000. This is either the value of the
+         * 'Particle weight' input parameter, or, if 'Measure particle weight'
+         * is set, the value that was determined from measured run times
+         * before the last repartitioning of the mesh.
+         */
+        unsigned int get_particle_weight() const;
+
+        /**
+         * Return whether the particle weight is determined from measured
+         * run times, i.e., whether the `repartition' load balancing strategy
+         * and 'Measure particle weight' are both selected.
+         */
+        bool particle_weight_is_measured() const;
+
+        /**
+         * Return the sum of the weights of all locally owned cells of this
+         * process, i.e., the quantity that is balanced across processes
+         * if the 'repartition' load balancing strategy is selected.
+         */
+        double get_local_load() const;
+
         /**
          * This callback function is registered within Simulator by the
          * constructor of this class and will be
@@ -288,7 +313,9 @@ namespace aspect
             remove_particles = 0x1,
             add_particles = 0x2,
             repartition = 0x4,
-            remove_and_add_particles = remove_particles | add_particles
+            remove_and_add_particles = remove_particles | add_particles,
+            merge_particles = 0x8,
+            split_particles = 0x10
           };
         };
 
@@ -370,6 +397,37 @@ namespace aspect
          */
         unsigned int particle_weight;
 
+        /**
+         * Whether to determine the particle weight from the measured
+         * run time of particle operations and of the assembly of the
+         * field-based systems, rather than using a fixed value.
+         */
+        bool measure_particle_weight;
+
+        /**
+         * A timer that accumulates the time this process spent on the
+         * per-cell work of updating and advecting particles since the last
+         * repartitioning. The timer only measures local work, so that
+         * waiting for other processes is not counted as particle work.
+         */
+        Timer particle_work_timer;
+
+        /**
+         * The total time spent in the assembly of the field-based systems
+         * at the time of the last repartitioning.
+         */
+        double last_assembly_time;
+
+        /**
+         * Set the particle weight from the ratio of the measured cost of
+         * a particle and the measured cost of a cell since the last call
+         * of this function. Called before each repartitioning of the mesh
+         * if 'Measure particle weight' is set. This function needs to be
+         * called on all processes.
+         */
+        void
+        update_measured_particle_weight();
+
         /**
          * Some particle interpolation algorithms require knowledge
          * about particles in neighboring cells. To allow this,
@@ -379,6 +437,54 @@ namespace aspect
          */
         bool update_ghost_particles;
 
+        /**
+         * Whether all integration steps of a time step are performed
+         * without sorting the particles into their new cells in between.
+         * See advect_particles_fused() for details.
+         */
+        bool fuse_integration_steps;
+
+        /**
+         * The names of the particle property fields that are used to decide
+         * whether particles are merged or split, and the indices of all of
+         * their components within the properties of a particle.
+         */
+        std::vector<std::string> interface_property_names;
+        std::vector<unsigned int> interface_property_components;
+
+        /**
+         * Two particles are considered to belong to the same material, and a
+         * cell is considered uniform, if none of the components in
+         * @p interface_property_components differs by more than this value.
+         */
+        double interface_property_tolerance;
+
+        /**
+         * The name of the particle property field that weights the
+         * averages of merged particles, and the index of its component
+         * within the properties of a particle. The index is
+         * numbers::invalid_unsigned_int if all particles are weighted
+         * equally.
+         */
+        std::string merge_weight_property_name;
+        unsigned int merge_weight_component;
+
+        /**
+         * The names of the particle property fields that are averaged when
+         * two particles are merged, in addition to the interface
+         * properties, and for each component of the particle properties
+         * whether it is averaged. Components that are not averaged keep the
+         * value of the particle that is kept.
+         */
+        std::vector<std::string> merge_averaged_property_names;
+        std::vector<bool> is_averaged_merge_component;
+
+        /**
+         * The number of time steps between two calls of
+         * merge_and_split_particles().
+         */
+        unsigned int merge_and_split_interval;
+
         /**
          * Get a map between subdomain id and the neighbor index. In other words
          * the returned map answers the question: Given a subdomain id, which
@@ -396,12 +502,36 @@ namespace aspect
         void
         apply_particle_per_cell_bounds();
 
+        /**
+         * Merge particles in cells in which the properties selected by
+         * 'Interface properties' are uniform, and split particles close to
+         * interfaces in these properties, if the appropriate
+         * @p particle_load_balancing strategies have been selected. This
+         * concentrates particles where the property information is needed,
+         * while the limits given by @p min_particles_per_cell and
+         * @p max_particles_per_cell are respected.
+         */
+        void
+        merge_and_split_particles();
+
         /**
          * Advect the particle positions by one integration step. Needs to be
          * called until integrator->continue() returns false.
          */
         void advect_particles();
 
+        /**
+         * Advect the particle positions through all integration steps of
+         * the current time step at once. In contrast to calling
+         * advect_particles() repeatedly, particles are not sorted into
+         * their new cells after each integration step. Instead, the cell
+         * that contains the intermediate position of a particle is found
+         * by searching the neighborhood of the cell that stores the particle,
+         * and particles are only sorted and transferred to other processes
+         * once at the end of the time step.
+         */
+        void advect_particles_fused();
+
         /**
          * Initialize the particle properties of one cell.
          */
@@ -463,6 +593,36 @@ namespace aspect
                                const typename ParticleHandler<dim>::particle_iterator &end_particle,
                                internal::SolutionEvaluators<dim> &evaluators);
 
+        /**
+         * Advect the particles that are stored in one cell by one integration
+         * step, without requiring that the particles are still located
+         * inside this cell. This is the per-cell part of
+         * advect_particles_fused(). If @p particles_are_sorted is true,
+         * all particles are known to be inside @p cell, and their
+         * reference locations are used directly. Otherwise, the cells around
+         * the current particle locations are found using @p grid_cache.
+         */
+        void
+        local_advect_particles_fused(const typename DoFHandler<dim>::active_cell_iterator &cell,
+                                     const typename ParticleHandler<dim>::particle_iterator &begin_particle,
+                                     const typename ParticleHandler<dim>::particle_iterator &end_particle,
+                                     internal::SolutionEvaluators<dim> &evaluators,
+                                     const GridTools::Cache<dim> &grid_cache,
+                                     const bool particles_are_sorted);
+
+        /**
+         * Evaluate the current and old velocity (or fluid velocity, if
+         * melt transport is active) at the points @p unit_positions
+         * given in the reference coordinates of @p cell, and store them in
+         * @p velocities and @p old_velocities.
+         */
+        void
+        evaluate_velocities(const typename DoFHandler<dim>::active_cell_iterator &cell,
+                            const ArrayView<const Point<dim>> &unit_positions,
+                            internal::SolutionEvaluators<dim> &evaluators,
+                            std::vector<Tensor<1,dim>> &velocities,
+                            std::vector<Tensor<1,dim>> &old_velocities) const;
+
         /**
          * This function registers the necessary functions to the
          * @p signals that the @p particle_handler needs to know about.
@@ -485,6 +645,22 @@ namespace aspect
       ar
       &(*particle_handler)
       ;
+
+      // The measured particle weight replaces the 'Particle weight' input
+      // parameter, so it has to survive a restart. It is only restored if
+      // it was measured both before and after the restart; otherwise the
+      // weight from the input file is used.
+      bool weight_was_measured = particle_weight_is_measured();
+      unsigned int measured_particle_weight = particle_weight;
+      ar
+      &weight_was_measured
+      &measured_particle_weight
+      ;
+
+      if (Archive::is_loading::value
+          && weight_was_measured
+          && particle_weight_is_measured())
+        particle_weight = measured_particle_weight;
     }
   }
 }
@@ -39,6 +39,17 @@ namespace aspect
   {
     namespace internal
     {
+      /**
+       * Return whether the particle with the given @p particle_id should be
+       * written to output files if only a fraction @p output_fraction of
+       * all particles should be written. The decision only depends on the
+       * id of the particle, so the same particles are selected every time
+       * output is written, and their paths can be followed over time.
+       */
+      bool
+      is_selected_for_output (const types::particle_index particle_id,
+                              const double output_fraction);
+
       /**
        * This class is responsible for writing the particle data into a format that can
        * be written by deal.II, in particular a list of 'patches' that contain one
@@ -55,11 +66,14 @@ namespace aspect
            * property information from @p property_information, and builds a list of patches that is stored
            * internally until the destructor is called. This function needs to be called before one of the
            * write function of the base class can be called to write the output data.
+           * Only the fraction @p output_fraction of all particles selected by
+           * is_selected_for_output() is included in the patches.
            */
           void build_patches(const Particles::ParticleHandler<dim> &particle_handler,
                              const aspect::Particle::Property::ParticlePropertyInformation &property_information,
                              const std::vector<std::string> &exclude_output_properties,
-                             const bool only_group_3d_vectors);
+                             const bool only_group_3d_vectors,
+                             const double output_fraction = 1.0);
 
         private:
           /**
@@ -281,6 +295,38 @@ namespace aspect
          */
         std::vector<std::string> exclude_output_properties;
 
+        /**
+         * The fraction of all particles that is written to output files.
+         */
+        double output_fraction;
+
+        /**
+         * Whether the blocks of data in the 'columnar' output format are
+         * compressed.
+         */
+        bool compress_columnar_output;
+
+        /**
+         * Write the ids, locations, and properties of all particles selected
+         * for output into the file @p filename in the 'columnar' format. In
+         * contrast to the other output formats, this format does not create
+         * any intermediate patches, but copies the particle data directly
+         * into one contiguous array per output quantity, which all processes
+         * then write into one file using MPI I/O.
+         *
+         * The file starts with a human-readable text header that describes
+         * the data in the file and ends with a line <code>end of
+         * header</code>. It is followed by an index with one row per process
+         * that contains the number of particles written by this process
+         * followed by the size in bytes of each of its columns, all stored
+         * as 64-bit unsigned integers. After the index follows one block of
+         * data per process, which contains the columns of this process one
+         * after the other in the order given in the header. If compression
+         * is enabled, each column of each process is compressed separately
+         * with zlib.
+         */
+        void write_columnar_output (const std::string &filename) const;
+
         /**
          * A function that writes the text in the second argument to a file
          * with the name given in the first argument. The function is run on a
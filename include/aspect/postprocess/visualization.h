@@ -517,6 +517,13 @@ namespace aspect
          */
         unsigned int group_files;
 
+        /**
+         * If true, the HDF5 output of all processes on one node is sent
+         * to one process of that node, and only these processes write the
+         * output files collectively.
+         */
+        bool aggregate_hdf5_output_per_node;
+
         /**
          * On large clusters it can be advantageous to first write the
          * output to a temporary file on a local file system and later
@@ -538,6 +545,31 @@ namespace aspect
          */
         bool interpolate_output;
 
+        /**
+         * The part of the domain for which cell based graphical output is
+         * written.
+         */
+        enum OutputRegion
+        {
+          entire_domain,
+          box,
+          depth_range
+        } output_region;
+
+        /**
+         * The lower and upper corners of the box for which graphical output
+         * is written if output_region is set to box.
+         */
+        Point<dim> output_region_minimum_point;
+        Point<dim> output_region_maximum_point;
+
+        /**
+         * The smallest and largest depth for which graphical output is
+         * written if output_region is set to depth_range.
+         */
+        double output_region_minimum_depth;
+        double output_region_maximum_depth;
+
         /**
          * deal.II offers the possibility to filter duplicate vertices in HDF5
          * output files. This merges the vertices of adjacent cells and
@@ -610,6 +642,13 @@ namespace aspect
          */
         void set_last_output_time (const double current_time);
 
+        /**
+         * Return whether the given cell intersects the region for which
+         * graphical output is requested, as selected by the output_region
+         * variable.
+         */
+        bool cell_is_in_output_region (const typename Triangulation<dim>::cell_iterator &cell) const;
+
         /**
          * Record that the mesh changed. This helps some output writers avoid
          * writing the same mesh multiple times.
@@ -69,6 +69,7 @@ DEAL_II_ENABLE_EXTRA_DIAGNOSTICS
 #include <boost/iostreams/tee.hpp>
 #include <boost/iostreams/stream.hpp>
 
+#include <exception>
 #include <memory>
 #include <thread>
 
@@ -724,6 +725,11 @@ namespace aspect
        * assemble_stokes_preconditioner(), then set up the data structures to
        * actually build a preconditioner from this matrix.
        *
+       * If the adaptive rebuild policy is selected in the input file, the
+       * function may instead decide to keep the previously built
+       * preconditioner, based on the information collected in
+       * stokes_preconditioner_monitor.
+       *
        * This function is implemented in
        * <code>source/simulator/assembly.cc</code>.
        */
@@ -783,6 +789,46 @@ namespace aspect
       std::vector<double> assemble_and_solve_composition (const std::vector<double> &initial_residual = {},
                                                           std::vector<double> *residual = nullptr);
 
+      /**
+       * Assemble and solve the advection equation for one field that is
+       * discretized with a finite element method. If advection subcycling
+       * is enabled (see the parameter ``Maximum advection subcycling
+       * level''), the field is advanced over the current time step in as
+       * many equal sub-steps as are necessary to satisfy the CFL condition
+       * for the current velocity, up to the maximal number of sub-steps.
+       * The velocity is kept fixed during all sub-steps, so only the
+       * advection systems, but not the Stokes system, are solved at the
+       * smaller step size.
+       *
+       * If the `residual` argument is not a `nullptr`, the norm of the
+       * right hand side of the (first) assembled system is stored in it.
+       * The function returns the initial residual of the (first) linear
+       * solve, see solve_advection().
+       *
+       * This function is implemented in
+       * <code>source/simulator/solver_schemes.cc</code>.
+       */
+      double assemble_and_solve_advection_field (const AdvectionField &advection_field,
+                                                 double *residual = nullptr);
+
+      /**
+       * Return the number of sub-steps into which the current time step
+       * has to be split for the advection equations, so that each of the
+       * sub-steps satisfies the CFL condition for the velocity stored in
+       * the current_linearization_point. The number of sub-steps is a power
+       * of two that is at most $2^l$, where $l$ is the ``Maximum advection
+       * subcycling level''.
+       *
+       * Computing this number requires a sweep over all cells, so it is
+       * only computed the first time this function is called in a time
+       * step, and then used for all fields and all nonlinear iterations of
+       * this time step (see @p n_advection_subcycles).
+       *
+       * This function is implemented in
+       * <code>source/simulator/helper_functions.cc</code>.
+       */
+      unsigned int get_n_advection_subcycles ();
+
       /**
        * Assemble and solve the Stokes equation.
        * This function returns the nonlinear residual after solving.
@@ -982,6 +1028,16 @@ namespace aspect
        */
       void create_snapshot();
 
+      /**
+       * Wait for a snapshot that create_snapshot() may still be writing in a
+       * background thread to be finished. If writing the snapshot failed
+       * with an exception, rethrow this exception on the calling thread.
+       *
+       * This function is implemented in
+       * <code>source/simulator/checkpoint_restart.cc</code>.
+       */
+      void wait_for_checkpoint_writer_thread();
+
       /**
        * Restore the state of this program from a set of files in the output
        * directory. In reality, however, only some variables are stored (in
@@ -1034,9 +1090,21 @@ namespace aspect
       void setup_system_matrix (const std::vector<IndexSet> &system_partitioning);
 
       /**
-       * Set up the size and structure of the matrix used to store the
+       * Determine which of the components of our finite-element system
+       * couple to each other in the matrix that is used to build the
+       * preconditioner for the Stokes system.
+       *
+       * This function is implemented in
+       * <code>source/simulator/core.cc</code>.
+       */
+      Table<2,DoFTools::Coupling>
+      setup_system_preconditioner_coupling () const;
+
+      /**
+       * Set up the structure of the matrix used to store the
        * elements of the matrix that is used to build the
-       * preconditioner for the system. This matrix is only used for
+       * preconditioner for the system, given the filled (but not yet
+       * compressed) sparsity pattern @p sp. This matrix is only used for
        * the Stokes system, so while it has the size of the whole
        * system, it only has entries in the velocity and pressure
        * blocks.
@@ -1044,7 +1112,19 @@ namespace aspect
        * This function is implemented in
        * <code>source/simulator/core.cc</code>.
        */
-      void setup_system_preconditioner (const std::vector<IndexSet> &system_partitioning);
+      void setup_system_preconditioner (LinearAlgebra::BlockDynamicSparsityPattern &sp);
+
+      /**
+       * Set up the system matrix and, if it is needed by the Stokes
+       * solver, the preconditioner matrix, and delete the existing
+       * preconditioners. The sparsity pattern of the preconditioner
+       * matrix is filled on a separate task while the one of the system
+       * matrix is being built.
+       *
+       * This function is implemented in
+       * <code>source/simulator/core.cc</code>.
+       */
+      void setup_system_matrices (const std::vector<IndexSet> &system_partitioning);
 
       /**
        * @}
@@ -1559,30 +1639,37 @@ namespace aspect
       double get_maximal_velocity (const LinearAlgebra::BlockVector &solution) const;
 
       /**
-       * Compute the variation (i.e., the difference between maximal and
-       * minimal value) of the entropy $(T-\bar T)^2$ where $\bar T$ is the
-       * average temperature throughout the domain given as argument to this
-       * function.
-       *
-       * This function is used in computing the artificial diffusion
-       * stabilization term.
-       *
-       * This function is implemented in
-       * <code>source/simulator/assembly.cc</code>.
+       * A structure that collects the global quantities that are needed to
+       * compute the entropy viscosity of one advected field: the minimal and
+       * maximal value of the field extrapolated from the previous time steps,
+       * the variation (i.e., the difference between maximal and minimal value)
+       * of the entropy $(T-\bar T)^2$ where $\bar T$ is the average of the
+       * extrapolated field range, and the maximal velocity of the previous
+       * time step.
        */
-      double get_entropy_variation (const double average_field,
-                                    const AdvectionField &advection_field) const;
+      struct AdvectionStabilizationStatistics
+      {
+        std::pair<double,double> field_range;
+        double entropy_variation;
+        double max_velocity;
+      };
 
       /**
-       * Compute the minimal and maximal temperature throughout the domain from
-       * a solution vector extrapolated from the previous time steps. This is
-       * needed to compute the artificial diffusion stabilization terms.
+       * Compute the global quantities needed for the entropy viscosity
+       * stabilization of all of the given advection fields. All fields are
+       * handled in the same loops over the mesh, and the results for all of
+       * them are communicated in the same MPI reductions, which is
+       * considerably cheaper than computing them one field at a time if
+       * there are many compositional fields.
+       *
+       * The entropy variation is only computed if the stabilization exponent
+       * $\alpha$ is 2, otherwise it is set to a signaling NaN.
        *
        * This function is implemented in
-       * <code>source/simulator/helper_functions.cc</code>.
+       * <code>source/simulator/entropy_viscosity.cc</code>.
        */
-      std::pair<double,double>
-      get_extrapolated_advection_field_range (const AdvectionField &advection_field) const;
+      std::vector<AdvectionStabilizationStatistics>
+      compute_advection_stabilization_statistics (const std::vector<AdvectionField> &advection_fields) const;
 
       /**
        * Exchange coarsen/refinement flags set between processors so that
@@ -1891,6 +1978,23 @@ namespace aspect
        */
       std::thread                         output_statistics_thread;
 
+      /**
+       * In create_snapshot(), process 0 can compress and write the
+       * serialized state of the simulation, and move the files of the new
+       * snapshot into place, on a separate thread. This variable is the
+       * handle for this thread so that we can wait for it to finish before
+       * creating the next snapshot, or before we terminate.
+       */
+      std::thread                         checkpoint_writer_thread;
+
+      /**
+       * An exception thrown while writing a snapshot on the
+       * checkpoint_writer_thread. Exceptions cannot leave a thread without
+       * terminating the program, so the thread stores them here, and
+       * wait_for_checkpoint_writer_thread() rethrows them.
+       */
+      std::exception_ptr                  checkpoint_writer_exception;
+
       /**
        * @}
        */
@@ -1964,6 +2068,14 @@ namespace aspect
       unsigned int                                              timestep_number;
       unsigned int                                              pre_refinement_step;
       unsigned int                                              nonlinear_iteration;
+
+      /**
+       * The number of sub-steps of the advection equations in the current
+       * time step, as computed by get_n_advection_subcycles(), or
+       * numbers::invalid_unsigned_int if it has not been computed yet in
+       * this time step. Reset in start_timestep().
+       */
+      unsigned int                                              n_advection_subcycles;
       /**
        * @}
        */
@@ -2095,11 +2207,66 @@ namespace aspect
       // only used if operator split is enabled
       LinearAlgebra::BlockVector                                operator_split_reaction_vector;
 
+      /**
+       * The entropy viscosity stabilization statistics of advected fields,
+       * indexed by AdvectionField::field_index(), that have been computed
+       * ahead of assembly for a group of fields at once. The map is only
+       * filled while the advection systems are assembled and solved, and
+       * get_artificial_viscosity() computes the statistics of a field
+       * itself if the field is not found in here.
+       */
+      std::map<unsigned int, AdvectionStabilizationStatistics> advection_stabilization_statistics;
+
 
 
       std::unique_ptr<LinearAlgebra::PreconditionAMG>           Amg_preconditioner;
       std::unique_ptr<LinearAlgebra::PreconditionBase>          Mp_preconditioner;
 
+      /**
+       * A structure that collects the information the adaptive rebuild
+       * policy of build_stokes_preconditioner() bases its decisions on,
+       * together with the number of decisions of either kind since they were
+       * last written to the statistics file.
+       */
+      struct StokesPreconditionerMonitor
+      {
+        /**
+         * The average of the decadic logarithm of the viscosity in each
+         * active cell, as computed during the last assembly of the Stokes
+         * matrix, and as it was when the preconditioner was last rebuilt.
+         */
+        Vector<float> log_viscosity;
+        Vector<float> log_viscosity_at_last_rebuild;
+
+        /**
+         * The number of outer iterations of the last Stokes solve, and of
+         * the first solve after the last rebuild of the preconditioner.
+         */
+        unsigned int  n_iterations;
+        unsigned int  n_iterations_after_last_rebuild;
+
+        /**
+         * The number of times the preconditioner was reused since it was
+         * last rebuilt.
+         */
+        unsigned int  n_reuses_since_last_rebuild;
+
+        /**
+         * Whether the next call to build_stokes_preconditioner() has to
+         * rebuild the preconditioner regardless of the criteria above.
+         */
+        bool          force_rebuild;
+
+        /**
+         * The number of rebuilds and reuses since the last output of the
+         * statistics.
+         */
+        unsigned int  n_rebuilds;
+        unsigned int  n_reuses;
+      };
+
+      StokesPreconditionerMonitor                               stokes_preconditioner_monitor;
+
       bool                                                      rebuild_sparsity_and_matrices;
       bool                                                      rebuild_stokes_matrix;
       bool                                                      assemble_newton_stokes_matrix;
@@ -0,0 +1,169 @@
+/*
+  Copyright (C) 2026 by the authors of the ASPECT code.
+
+  This file is part of ASPECT.
+
+  ASPECT is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2, or (at your option)
+  any later version.
+
+  ASPECT is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with ASPECT; see the file LICENSE.  If not see
+  <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef _aspect_time_stepping_error_controlled_time_step_h
+#define _aspect_time_stepping_error_controlled_time_step_h
+
+#include <aspect/time_stepping/interface.h>
+
+
+namespace aspect
+{
+  namespace TimeStepping
+  {
+    using namespace dealii;
+
+    /**
+     * A time stepping plugin that chooses the time step size based on an
+     * estimate of the time discretization error of the last time step.
+     *
+     * The error of the advected fields (temperature and compositional
+     * fields solved by the finite element method) is estimated by the
+     * difference between the computed solution and the linear
+     * extrapolation of the two previous solutions to the current time. The
+     * error of the surface topography (if the mesh is deformed) is
+     * estimated by the difference between the boundary displacement
+     * computed with the new and with the old velocity. These estimates are
+     * scaled by user-given tolerances, and the next time step size is
+     * computed from the scaled error of the current and the previous time
+     * step with a proportional-integral (PI) controller. If the scaled
+     * error of the current time step exceeds one, the time step is rejected
+     * and repeated with a smaller step size.
+     *
+     * The error estimate does not guarantee the stability of the advection
+     * schemes, so this plugin has to be combined with the "convection time
+     * step" plugin.
+     *
+     * @ingroup TimeStepping
+     */
+    template <int dim>
+    class ErrorControlledTimeStep : public Interface<dim>, public SimulatorAccess<dim>
+    {
+      public:
+        /**
+         * Constructor.
+         */
+        ErrorControlledTimeStep ();
+
+        /**
+         * @copydoc aspect::TimeStepping::Interface<dim>::execute()
+         */
+        double
+        execute() override;
+
+        /**
+         * Repeat the current time step if its estimated error exceeds the
+         * tolerance.
+         */
+        std::pair<Reaction, double>
+        determine_reaction(const TimeStepInfo &info) override;
+
+        static
+        void
+        declare_parameters (ParameterHandler &prm);
+
+        void
+        parse_parameters (ParameterHandler &prm) override;
+
+        /**
+         * Save the state of this object.
+         */
+        void save (std::map<std::string, std::string> &status_strings) const override;
+
+        /**
+         * Restore the state of the object.
+         */
+        void load (const std::map<std::string, std::string> &status_strings) override;
+
+        /**
+         * Serialize the contents of this class as far as they are not read
+         * from input parameter files.
+         */
+        template <class Archive>
+        void serialize (Archive &ar, const unsigned int version);
+
+      private:
+        /**
+         * Compute the estimated error of the advected fields in the current
+         * time step, relative to the field tolerance.
+         */
+        double
+        compute_field_error () const;
+
+        /**
+         * Compute the estimated error of the surface topography in the
+         * current time step, relative to the topography tolerance.
+         */
+        double
+        compute_topography_error () const;
+
+        /**
+         * The tolerance for the error of the advected fields, relative to
+         * the range of values of each field.
+         */
+        double field_tolerance;
+
+        /**
+         * The tolerance for the error of the surface topography, in meters.
+         */
+        double topography_tolerance;
+
+        /**
+         * Safety factor by which the time step size proposed by the
+         * controller is multiplied.
+         */
+        double safety_factor;
+
+        /**
+         * The smallest factor by which the time step size can be reduced
+         * from one step to the next, or when a step is repeated.
+         */
+        double minimum_reduction_factor;
+
+        /**
+         * The maximal number of times in a row that a time step is repeated
+         * because its error is too large. After this, the time step is
+         * accepted regardless of its error.
+         */
+        unsigned int maximum_repetitions;
+
+        /**
+         * The scaled error of the time step that was computed last, as
+         * computed in execute().
+         */
+        double current_error;
+
+        /**
+         * The scaled error of the last accepted time step, used by the
+         * proportional part of the controller.
+         */
+        double previous_error;
+
+        /**
+         * The number of times the current time step has been repeated.
+         */
+        unsigned int n_repetitions;
+    };
+  }
+}
+
+
+#endif
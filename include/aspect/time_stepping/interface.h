@@ -26,6 +26,8 @@
 #include <aspect/simulator_access.h>
 #include <aspect/termination_criteria/interface.h>
 
+#include <boost/serialization/split_member.hpp>
+
 namespace aspect
 {
   using namespace dealii;
@@ -164,6 +166,28 @@ namespace aspect
         virtual
         void
         parse_parameters (ParameterHandler &prm);
+
+        /**
+         * Save the state of this object to the argument given to this
+         * function, as part of a checkpoint. The state is stored as a string
+         * under a key that is specific to the derived class, and from which
+         * it can later be restored by load().
+         *
+         * The default implementation of this function does nothing, i.e., it
+         * represents a stateless object.
+         */
+        virtual
+        void save (std::map<std::string, std::string> &status_strings) const;
+
+        /**
+         * Restore the state of the object by looking up a description of the
+         * state in the passed argument under the same key under which it was
+         * previously stored.
+         *
+         * The default implementation does nothing.
+         */
+        virtual
+        void load (const std::map<std::string, std::string> &status_strings);
     };
 
 
@@ -247,6 +271,24 @@ namespace aspect
         void
         write_plugin_graph (std::ostream &output_stream);
 
+        /**
+         * Write the data of this object to a stream for the purpose of
+         * serialization.
+         */
+        template <class Archive>
+        void save (Archive &ar,
+                   const unsigned int version) const;
+
+        /**
+         * Read the data of this object from a stream for the purpose of
+         * serialization.
+         */
+        template <class Archive>
+        void load (Archive &ar,
+                   const unsigned int version);
+
+        BOOST_SERIALIZATION_SPLIT_MEMBER()
+
 
         /**
          * A function that is used to register time stepping model objects in such
@@ -308,6 +350,41 @@ namespace aspect
         std::list<std::unique_ptr<Interface<dim>>> active_plugins;
     };
 
+
+    /* -------------------------- inline and template functions ---------------------- */
+
+    template <int dim>
+    template <class Archive>
+    void Manager<dim>::save (Archive &ar,
+                             const unsigned int) const
+    {
+      // let all the plugins save their data in a map and then
+      // serialize that
+      std::map<std::string,std::string> saved_text;
+      for (const auto &p : active_plugins)
+        p->save (saved_text);
+
+      ar &saved_text;
+    }
+
+
+    template <int dim>
+    template <class Archive>
+    void Manager<dim>::load (Archive &ar,
+                             const unsigned int)
+    {
+      // get the map back out of the stream; then let the plugins
+      // that we currently have get their data from there. note that this
+      // may not be the same set of plugins we had when we saved
+      // their data
+      std::map<std::string,std::string> saved_text;
+      ar &saved_text;
+
+      for (auto &p : active_plugins)
+        p->load (saved_text);
+    }
+
+
     /**
      * Given a class name, a name, and a description for the parameter file, register it with the
      * aspect::TimeStepping::Manager class.
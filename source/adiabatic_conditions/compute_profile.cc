@@ -26,6 +26,9 @@
 
 #include <deal.II/base/signaling_nan.h>
 
+#include <array>
+#include <cstdint>
+
 
 namespace aspect
 {
@@ -46,8 +49,16 @@ namespace aspect
     {
       if (use_surface_condition_function)
         {
-          initialized = false;
           surface_condition_function.set_time(this->get_time());
+
+          // nothing to do if the surface conditions are the same as the
+          // ones the current profile was computed for
+          if (initialized
+              && surface_condition_function.value(Point<1>(0.0),0) == pressures[0]
+              && surface_condition_function.value(Point<1>(0.0),1) == temperatures[0])
+            return;
+
+          initialized = false;
           initialize();
         }
     }
@@ -75,12 +86,16 @@ namespace aspect
 
       delta_z = this->get_geometry_model().maximal_depth() / (n_points-1);
 
-      MaterialModel::MaterialModelInputs<dim> in(1, this->n_compositional_fields());
-      MaterialModel::MaterialModelOutputs<dim> out(1, this->n_compositional_fields());
-
-      // Constant properties on the reference profile
-      in.requested_properties = MaterialModel::MaterialProperties::equation_of_state_properties;
-      in.velocity[0] = Tensor <1,dim> ();
+      if (!use_surface_condition_function)
+        {
+          pressures[0] = this->get_surface_pressure();
+          temperatures[0] = this->get_adiabatic_surface_temperature();
+        }
+      else
+        {
+          pressures[0] = surface_condition_function.value(Point<1>(0.0),0);
+          temperatures[0] = surface_condition_function.value(Point<1>(0.0),1);
+        }
 
       // Check whether gravity is pointing up / out or down / in. In the normal case it should
       // point down / in and therefore gravity should be positive, leading to increasing
@@ -94,26 +109,77 @@ namespace aspect
                                      1 :
                                      -1;
 
+      if (integration_scheme == explicit_euler)
+        integrate_explicit_euler (gravity_direction);
+      else if (integration_scheme == runge_kutta_4)
+        integrate_runge_kutta (gravity_direction);
+      else
+        AssertThrow(false, ExcNotImplemented());
+
+      if (gravity_direction == 1 && this->get_surface_pressure() >= 0)
+        {
+          Assert (*std::min_element (pressures.begin(), pressures.end()) >=
+                  -std::numeric_limits<double>::epsilon() * pressures.size(),
+                  ExcMessage("Adiabatic ComputeProfile encountered a negative pressure of "
+                             + dealii::Utilities::to_string(*std::min_element (pressures.begin(), pressures.end()))));
+        }
+      else if (gravity_direction == -1 && this->get_surface_pressure() <= 0)
+        {
+          Assert (*std::max_element (pressures.begin(), pressures.end()) <=
+                  std::numeric_limits<double>::epsilon() * pressures.size(),
+                  ExcMessage("Adiabatic ComputeProfile encountered a positive pressure of "
+                             + dealii::Utilities::to_string(*std::max_element (pressures.begin(), pressures.end()))));
+        }
+
+      Assert (*std::min_element (temperatures.begin(), temperatures.end()) >=
+              -std::numeric_limits<double>::epsilon() * temperatures.size(),
+              ExcMessage("Adiabatic ComputeProfile encountered a negative temperature."));
+
+
+      initialized = true;
+    }
+
+
+
+    template <int dim>
+    void
+    ComputeProfile<dim>::set_reference_composition (MaterialModel::MaterialModelInputs<dim> &in,
+                                                    const unsigned int q) const
+    {
+      if (reference_composition == initial_composition)
+        for (unsigned int c=0; c<this->n_compositional_fields(); ++c)
+          in.composition[q][c] = initial_composition_manager->initial_composition(in.position[q], c);
+      else if (reference_composition == reference_function)
+        {
+          const double depth = this->get_geometry_model().depth(in.position[q]);
+          const Point<1> p(depth);
+          for (unsigned int c=0; c<this->n_compositional_fields(); ++c)
+            in.composition[q][c] = composition_function->value(p, c);
+        }
+      else
+        AssertThrow(false,ExcNotImplemented());
+    }
+
+
+
+    template <int dim>
+    void
+    ComputeProfile<dim>::integrate_explicit_euler (const int gravity_direction)
+    {
+      MaterialModel::MaterialModelInputs<dim> in(1, this->n_compositional_fields());
+      MaterialModel::MaterialModelOutputs<dim> out(1, this->n_compositional_fields());
+
+      // Constant properties on the reference profile
+      in.requested_properties = MaterialModel::MaterialProperties::equation_of_state_properties;
+      in.velocity[0] = Tensor <1,dim> ();
+
       // now integrate downward using the explicit Euler method for simplicity
       //
       // note: p'(z) = rho(p,T) * |g|
       //       T'(z) = alpha |g| T / C_p
       for (unsigned int i=0; i<n_points; ++i)
         {
-          if (i==0)
-            {
-              if (!use_surface_condition_function)
-                {
-                  pressures[0] = this->get_surface_pressure();
-                  temperatures[0] = this->get_adiabatic_surface_temperature();
-                }
-              else
-                {
-                  pressures[0] = surface_condition_function.value(Point<1>(0.0),0);
-                  temperatures[0] = surface_condition_function.value(Point<1>(0.0),1);
-                }
-            }
-          else
+          if (i>0)
             {
               // use material properties calculated at i-1
               const double density = out.densities[0];
@@ -151,45 +217,160 @@ namespace aspect
           else
             in.pressure_gradient[0] = Tensor <1,dim> ();
 
-          if (reference_composition == initial_composition)
-            for (unsigned int c=0; c<this->n_compositional_fields(); ++c)
-              in.composition[0][c] = initial_composition_manager->initial_composition(representative_point, c);
-          else if (reference_composition == reference_function)
-            {
-              const double depth = this->get_geometry_model().depth(representative_point);
-              const Point<1> p(depth);
-              for (unsigned int c=0; c<this->n_compositional_fields(); ++c)
-                in.composition[0][c] = composition_function->value(p, c);
-            }
-          else
-            AssertThrow(false,ExcNotImplemented());
+          set_reference_composition (in, 0);
 
           this->get_material_model().evaluate(in, out);
 
           densities[i] = out.densities[0];
         }
+    }
 
-      if (gravity_direction == 1 && this->get_surface_pressure() >= 0)
+
+
+    template <int dim>
+    void
+    ComputeProfile<dim>::integrate_runge_kutta (const int gravity_direction)
+    {
+      const double maximal_depth = this->get_geometry_model().maximal_depth();
+      const double step_size = maximal_depth / n_integration_steps;
+
+      MaterialModel::MaterialModelInputs<dim> in(1, this->n_compositional_fields());
+      MaterialModel::MaterialModelOutputs<dim> out(1, this->n_compositional_fields());
+      in.requested_properties = MaterialModel::MaterialProperties::equation_of_state_properties;
+      in.velocity[0] = Tensor <1,dim> ();
+
+      // the right hand side of the hydrostatic equations for y = (p,T):
+      //   p'(z) = rho(p,T) * |g|
+      //   T'(z) = alpha |g| T / C_p
+      // the pressure gradient input of the material model is set from the
+      // last known value of p'(z)
+      double last_pressure_derivative = 0.;
+      const auto evaluate_rhs = [&] (const double z,
+                                     const std::array<double,2> &y) -> std::array<double,2>
+      {
+        const Point<dim> representative_point = this->get_geometry_model().representative_point (z);
+        const Tensor <1,dim> g = this->get_gravity_model().gravity_vector(representative_point);
+
+        in.position[0] = representative_point;
+        in.pressure[0] = y[0];
+        in.temperature[0] = y[1];
+        in.pressure_gradient[0] = g/(g.norm() != 0.0 ? g.norm() : 1.0) * last_pressure_derivative;
+        set_reference_composition (in, 0);
+
+        this->get_material_model().evaluate(in, out);
+
+        // see integrate_explicit_euler() for the treatment of cp == 0
+        const double one_over_cp = (out.specific_heat[0]>0.0) ? 1.0/out.specific_heat[0] : 0.0;
+        const double gravity = gravity_direction * g.norm();
+
+        last_pressure_derivative = out.densities[0] * gravity;
+        return {{last_pressure_derivative,
+                 (this->include_adiabatic_heating())
+                 ?
+                 out.thermal_expansion_coefficients[0] * gravity * y[1] * one_over_cp
+                 :
+                 0.
+                }};
+      };
+
+      // integrate downward with the classical fourth order Runge-Kutta
+      // method on a grid that is typically much coarser than the one of
+      // the tables, and keep the solution and its derivative at each node
+      std::vector<std::array<double,2>> y (n_integration_steps+1);
+      std::vector<std::array<double,2>> dy_dz (n_integration_steps+1);
+      y[0] = {{pressures[0], temperatures[0]}};
+      dy_dz[0] = evaluate_rhs (0., y[0]);
+
+      for (unsigned int k=0; k<n_integration_steps; ++k)
         {
-          Assert (*std::min_element (pressures.begin(), pressures.end()) >=
-                  -std::numeric_limits<double>::epsilon() * pressures.size(),
-                  ExcMessage("Adiabatic ComputeProfile encountered a negative pressure of "
-                             + dealii::Utilities::to_string(*std::min_element (pressures.begin(), pressures.end()))));
+          const double z = k * step_size;
+          const auto stage = [&] (const std::array<double,2> &slope, const double factor)
+          {
+            return std::array<double,2> {{y[k][0] + factor * step_size * slope[0],
+                                          y[k][1] + factor * step_size * slope[1]
+                                         }};
+          };
+
+          const std::array<double,2> &k1 = dy_dz[k];
+          const std::array<double,2> k2 = evaluate_rhs (z + 0.5*step_size, stage(k1, 0.5));
+          const std::array<double,2> k3 = evaluate_rhs (z + 0.5*step_size, stage(k2, 0.5));
+          const std::array<double,2> k4 = evaluate_rhs (z + step_size, stage(k3, 1.));
+
+          for (unsigned int d=0; d<2; ++d)
+            y[k+1][d] = y[k][d] + step_size / 6. * (k1[d] + 2.*k2[d] + 2.*k3[d] + k4[d]);
+
+          // the derivative at the end of the step is the first stage of
+          // the next one
+          dy_dz[k+1] = evaluate_rhs ((k+1) * step_size, y[k+1]);
         }
-      else if (gravity_direction == -1 && this->get_surface_pressure() <= 0)
+
+      // fill the tables by cubic Hermite interpolation between the nodes of
+      // the integration, which is as accurate as the integration itself
+      std::vector<double> pressure_derivatives (n_points);
+      for (unsigned int i=1; i<n_points; ++i)
         {
-          Assert (*std::max_element (pressures.begin(), pressures.end()) <=
-                  std::numeric_limits<double>::epsilon() * pressures.size(),
-                  ExcMessage("Adiabatic ComputeProfile encountered a positive pressure of "
-                             + dealii::Utilities::to_string(*std::max_element (pressures.begin(), pressures.end()))));
+          const double z = i * delta_z;
+          const unsigned int k = std::min (static_cast<unsigned int>(z / step_size), n_integration_steps-1);
+          const double s = std::min (std::max ((z - k*step_size) / step_size, 0.), 1.);
+
+          const double h00 = (1. + 2.*s) * (1.-s) * (1.-s);
+          const double h10 = s * (1.-s) * (1.-s);
+          const double h01 = s * s * (3. - 2.*s);
+          const double h11 = s * s * (s - 1.);
+
+          pressures[i] = h00 * y[k][0] + h10 * step_size * dy_dz[k][0]
+                         + h01 * y[k+1][0] + h11 * step_size * dy_dz[k+1][0];
+          temperatures[i] = h00 * y[k][1] + h10 * step_size * dy_dz[k][1]
+                            + h01 * y[k+1][1] + h11 * step_size * dy_dz[k+1][1];
+
+          const double dh00 = 6. * s * (s - 1.);
+          const double dh10 = (1.-s) * (1. - 3.*s);
+          const double dh01 = -dh00;
+          const double dh11 = s * (3.*s - 2.);
+          pressure_derivatives[i] = (dh00 * y[k][0] + dh01 * y[k+1][0]) / step_size
+                                    + dh10 * dy_dz[k][0] + dh11 * dy_dz[k+1][0];
         }
+      pressure_derivatives[0] = dy_dz[0][0];
+
+      // the densities at the table points only depend on the pressure and
+      // temperature computed above, so the evaluation of the material model
+      // can be split among all processes, and does not need to be done
+      // one point at a time
+      const unsigned int n_processes = Utilities::MPI::n_mpi_processes(this->get_mpi_communicator());
+      const unsigned int this_process = Utilities::MPI::this_mpi_process(this->get_mpi_communicator());
+      const unsigned int begin = static_cast<unsigned int>((static_cast<std::uint64_t>(n_points) * this_process) / n_processes);
+      const unsigned int end = static_cast<unsigned int>((static_cast<std::uint64_t>(n_points) * (this_process+1)) / n_processes);
+
+      std::vector<double> local_densities (n_points, 0.);
+      if (end > begin)
+        {
+          MaterialModel::MaterialModelInputs<dim> table_in(end-begin, this->n_compositional_fields());
+          MaterialModel::MaterialModelOutputs<dim> table_out(end-begin, this->n_compositional_fields());
+          table_in.requested_properties = MaterialModel::MaterialProperties::equation_of_state_properties;
 
-      Assert (*std::min_element (temperatures.begin(), temperatures.end()) >=
-              -std::numeric_limits<double>::epsilon() * temperatures.size(),
-              ExcMessage("Adiabatic ComputeProfile encountered a negative temperature."));
+          for (unsigned int i=begin; i<end; ++i)
+            {
+              const unsigned int q = i - begin;
+              const Point<dim> representative_point
+                = this->get_geometry_model().representative_point (double(i)/double(n_points-1)*maximal_depth);
+              const Tensor <1,dim> g = this->get_gravity_model().gravity_vector(representative_point);
+
+              table_in.position[q] = representative_point;
+              table_in.temperature[q] = temperatures[i];
+              table_in.pressure[q] = pressures[i];
+              table_in.pressure_gradient[q] = g/(g.norm() != 0.0 ? g.norm() : 1.0) * pressure_derivatives[i];
+              table_in.velocity[q] = Tensor <1,dim> ();
+              set_reference_composition (table_in, q);
+            }
 
+          this->get_material_model().evaluate(table_in, table_out);
 
-      initialized = true;
+          for (unsigned int i=begin; i<end; ++i)
+            local_densities[i] = table_out.densities[i-begin];
+        }
+
+      // every entry has been computed by exactly one process
+      Utilities::MPI::sum (local_densities, this->get_mpi_communicator(), densities);
     }
 
 
@@ -315,12 +496,35 @@ namespace aspect
                              "profile. The higher the number of points, the more accurate "
                              "the downward integration from the adiabatic surface "
                              "temperature will be.");
+          prm.declare_entry ("Integration scheme", "explicit Euler",
+                             Patterns::Selection("explicit Euler|Runge-Kutta 4"),
+                             "The method used to integrate the hydrostatic equations for "
+                             "pressure and temperature in depth. ``explicit Euler'' "
+                             "integrates on the 'Number of points' points of the profile, "
+                             "evaluating the material model one point after the other. "
+                             "``Runge-Kutta 4'' uses the classical fourth order Runge-Kutta "
+                             "method with 'Number of integration steps' steps and interpolates "
+                             "the result to the points of the profile. This is much more "
+                             "accurate for the same number of evaluations of the material "
+                             "model, and the densities at the points of the profile are "
+                             "computed in a single evaluation of the material model that is "
+                             "split among all processes. For material models with "
+                             "discontinuous properties (e.g., phase transitions), the "
+                             "Runge-Kutta method is only first order accurate, and the number "
+                             "of integration steps should be chosen accordingly.");
+          prm.declare_entry ("Number of integration steps", "100",
+                             Patterns::Integer (1),
+                             "The number of steps of the Runge-Kutta integration of the "
+                             "adiabatic profile. Each step requires four evaluations of the "
+                             "material model. Only used if the 'Integration scheme' is "
+                             "``Runge-Kutta 4''.");
           prm.declare_entry ("Use surface condition function", "false",
                              Patterns::Bool(),
                              "Whether to use the 'Surface condition function' to determine surface "
                              "conditions, or the 'Adiabatic surface temperature' and 'Surface pressure' "
                              "parameters. If this is set to true the reference profile is updated "
-                             "every timestep. The function expression of the function should be "
+                             "every timestep in which the surface conditions have changed. The "
+                             "function expression of the function should be "
                              "independent of space, but can depend on time 't'. The function must "
                              "return two components, the first one being reference surface pressure, "
                              "the second one being reference surface temperature.");
@@ -376,6 +580,15 @@ namespace aspect
             }
 
           n_points = prm.get_integer ("Number of points");
+          n_integration_steps = prm.get_integer ("Number of integration steps");
+
+          const std::string scheme = prm.get("Integration scheme");
+          if (scheme == "explicit Euler")
+            integration_scheme = explicit_euler;
+          else if (scheme == "Runge-Kutta 4")
+            integration_scheme = runge_kutta_4;
+          else
+            AssertThrow(false, ExcNotImplemented());
           use_surface_condition_function = prm.get_bool("Use surface condition function");
           if (use_surface_condition_function)
             {
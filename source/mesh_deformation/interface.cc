@@ -808,6 +808,42 @@ namespace aspect
 
 
 
+    namespace
+    {
+      /**
+       * Return whether the two (closed) constraint objects constrain the
+       * same degrees of freedom in terms of the same other degrees of
+       * freedom, regardless of the weights and inhomogeneities of the
+       * constraints. If this is the case, they lead to the same sparsity
+       * pattern when used to eliminate constrained degrees of freedom.
+       */
+      bool
+      have_same_structure (const AffineConstraints<double> &constraints_1,
+                           const AffineConstraints<double> &constraints_2)
+      {
+        if (constraints_1.n_constraints() != constraints_2.n_constraints())
+          return false;
+
+        auto line_2 = constraints_2.get_lines().begin();
+        for (const auto &line_1 : constraints_1.get_lines())
+          {
+            if (line_1.index != line_2->index ||
+                line_1.entries.size() != line_2->entries.size())
+              return false;
+
+            for (unsigned int i=0; i<line_1.entries.size(); ++i)
+              if (line_1.entries[i].first != line_2->entries[i].first)
+                return false;
+
+            ++line_2;
+          }
+
+        return true;
+      }
+    }
+
+
+
     template <int dim>
     void MeshDeformationHandler<dim>::compute_mesh_displacements()
     {
@@ -848,18 +884,39 @@ namespace aspect
       for (unsigned int c=0; c<dim; ++c)
         coupling[c][c] = DoFTools::always;
 
-      LinearAlgebra::SparseMatrix mesh_matrix;
-      TrilinosWrappers::SparsityPattern sp (mesh_locally_owned,
-                                            mesh_locally_owned,
-                                            mesh_locally_relevant,
-                                            sim.mpi_communicator);
-      DoFTools::make_sparsity_pattern (mesh_deformation_dof_handler,
-                                       coupling, sp,
-                                       mesh_velocity_constraints, false,
-                                       Utilities::MPI::
-                                       this_mpi_process(sim.mpi_communicator));
-      sp.compress();
-      mesh_matrix.reinit (sp);
+      // The sparsity pattern only needs to be rebuilt if the constrained
+      // degrees of freedom have changed since the matrix was last built
+      // (the matrix and the constraints are cleared in setup_dofs()).
+      // Otherwise, we can reuse the matrix and just overwrite its entries.
+      const bool same_sparsity_pattern
+        = (mesh_matrix.m() == mesh_deformation_dof_handler.n_dofs())
+          &&
+          (Utilities::MPI::min(have_same_structure(mesh_velocity_constraints,
+                                                   mesh_matrix_constraints) ? 1 : 0,
+                               sim.mpi_communicator) == 1);
+
+      if (same_sparsity_pattern)
+        mesh_matrix = 0;
+      else
+        {
+          // The preconditioner stores a reference to the matrix, so
+          // release it before the matrix is reinitialized.
+          mesh_preconditioner.reset();
+
+          TrilinosWrappers::SparsityPattern sp (mesh_locally_owned,
+                                                mesh_locally_owned,
+                                                mesh_locally_relevant,
+                                                sim.mpi_communicator);
+          DoFTools::make_sparsity_pattern (mesh_deformation_dof_handler,
+                                           coupling, sp,
+                                           mesh_velocity_constraints, false,
+                                           Utilities::MPI::
+                                           this_mpi_process(sim.mpi_communicator));
+          sp.compress();
+          mesh_matrix.reinit (sp);
+
+          mesh_matrix_constraints.copy_from(mesh_velocity_constraints);
+        }
 
       // carry out the solution
       FEValuesExtractors::Vector extract_vel(0);
@@ -894,20 +951,16 @@ namespace aspect
       rhs.compress (VectorOperation::add);
       mesh_matrix.compress (VectorOperation::add);
 
-      // Make the AMG preconditioner
-      std::vector<std::vector<bool>> constant_modes;
-      DoFTools::extract_constant_modes (mesh_deformation_dof_handler,
-                                        ComponentMask(dim, true),
-                                        constant_modes);
-      // TODO: think about keeping object between time steps
-      LinearAlgebra::PreconditionAMG preconditioner_stiffness;
-      LinearAlgebra::PreconditionAMG::AdditionalData Amg_data;
-      Amg_data.constant_modes = constant_modes;
-      Amg_data.elliptic = true;
-      Amg_data.higher_order_elements = false;
-      Amg_data.smoother_sweeps = 2;
-      Amg_data.aggregation_threshold = 0.02;
-      preconditioner_stiffness.initialize(mesh_matrix);
+      // Make the AMG preconditioner, or, if the sparsity pattern of the
+      // matrix did not change, only recompute it for the new matrix entries
+      // while keeping the aggregation of the existing AMG hierarchy.
+      if (mesh_preconditioner)
+        mesh_preconditioner->reinit();
+      else
+        {
+          mesh_preconditioner = std::make_unique<LinearAlgebra::PreconditionAMG>();
+          mesh_preconditioner->initialize(mesh_matrix);
+        }
 
       // we solve with higher accuracy in the initial timestep:
       const double tolerance
@@ -917,7 +970,7 @@ namespace aspect
       SolverControl solver_control(5*rhs.size(), tolerance * rhs.l2_norm());
       SolverCG<LinearAlgebra::Vector> cg(solver_control);
 
-      cg.solve (mesh_matrix, solution, rhs, preconditioner_stiffness);
+      cg.solve (mesh_matrix, solution, rhs, *mesh_preconditioner);
       this->get_pcout() << "   Solving mesh displacement system... " << solver_control.last_step() <<" iterations."<< std::endl;
 
       mesh_velocity_constraints.distribute (solution);
@@ -1415,6 +1468,12 @@ namespace aspect
       DoFTools::extract_locally_relevant_dofs (mesh_deformation_dof_handler,
                                                mesh_locally_relevant);
 
+      // The degrees of freedom have changed, so the matrix of the mesh
+      // deformation system and its preconditioner need to be rebuilt.
+      mesh_preconditioner.reset();
+      mesh_matrix.clear();
+      mesh_matrix_constraints.clear();
+
       // This will initialize the mesh displacement and free surface
       // mesh velocity vectors with zero-valued entries.
       mesh_displacements.reinit(mesh_locally_owned, mesh_locally_relevant, sim.mpi_communicator);
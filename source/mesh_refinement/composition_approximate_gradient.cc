@@ -41,12 +41,29 @@ namespace aspect
       LinearAlgebra::BlockVector vec(this->introspection().index_sets.system_partitioning,
                                      this->introspection().index_sets.system_relevant_partitioning,
                                      this->get_mpi_communicator());
-      Vector<float> indicators_tmp(this->get_triangulation().n_active_cells());
       for (unsigned int c=0; c<this->n_compositional_fields(); ++c)
         {
           const unsigned int block_idx = this->introspection().block_indices.compositional_fields[c];
           vec.block(block_idx) = this->get_solution().block(block_idx);
-          vec.compress(VectorOperation::insert);
+        }
+      vec.compress(VectorOperation::insert);
+
+      // Scale approximated gradient in each cell with the correct power of h. Otherwise,
+      // error indicators do not reduce when refined if there is a density
+      // jump. We need at least order 1 for the error not to grow when
+      // refining, so anything >1 should work. (note that the gradient
+      // itself scales like 1/h, so multiplying it with any factor h^s, s>1
+      // will yield convergence of the error indicators to zero as h->0)
+      // This factor is the same for all fields, so compute it only once.
+      const double power = 1.0 + dim / 2.0;
+      Vector<double> cell_size_scaling(this->get_triangulation().n_active_cells());
+      for (const auto &cell : this->get_dof_handler().active_cell_iterators())
+        if (cell->is_locally_owned())
+          cell_size_scaling(cell->active_cell_index()) = std::pow(cell->diameter(), power);
+
+      Vector<float> indicators_tmp(this->get_triangulation().n_active_cells());
+      for (unsigned int c=0; c<this->n_compositional_fields(); ++c)
+        {
           indicators_tmp = 0;
           DerivativeApproximation::approximate_gradient(this->get_mapping(),
                                                         this->get_dof_handler(),
@@ -55,17 +72,7 @@ namespace aspect
                                                         this->introspection().component_indices.compositional_fields[c]);
 
           indicators_tmp *= composition_scaling_factors[c];
-
-          // Scale approximated gradient in each cell with the correct power of h. Otherwise,
-          // error indicators do not reduce when refined if there is a density
-          // jump. We need at least order 1 for the error not to grow when
-          // refining, so anything >1 should work. (note that the gradient
-          // itself scales like 1/h, so multiplying it with any factor h^s, s>1
-          // will yield convergence of the error indicators to zero as h->0)
-          const double power = 1.0 + dim / 2.0;
-          for (const auto &cell : this->get_dof_handler().active_cell_iterators())
-            if (cell->is_locally_owned())
-              indicators_tmp(cell->active_cell_index()) *= std::pow(cell->diameter(), power);
+          indicators_tmp.scale(cell_size_scaling);
 
           indicators += indicators_tmp;
         }
@@ -50,13 +50,19 @@ namespace aspect
       // we have to extract them in this structure
       std::vector<Tensor<1,dim>> composition_gradients (quadrature.size());
 
-      for (unsigned int c=0; c<this->n_compositional_fields(); ++c)
-        {
-          for (const auto &cell : this->get_dof_handler().active_cell_iterators())
-            if (cell->is_locally_owned())
+      // Loop over the cells only once, and compute the contributions of
+      // all compositional fields for each cell, so that the FEValues object
+      // only needs to be reinitialized once per cell.
+      for (const auto &cell : this->get_dof_handler().active_cell_iterators())
+        if (cell->is_locally_owned())
+          {
+            const unsigned int idx = cell->active_cell_index();
+            fe_values.reinit(cell);
+
+            const double cell_size_scaling = std::pow(cell->diameter(), power);
+
+            for (unsigned int c=0; c<this->n_compositional_fields(); ++c)
               {
-                const unsigned int idx = cell->active_cell_index();
-                fe_values.reinit(cell);
                 fe_values[this->introspection().extractors.compositional_fields[c]].get_function_gradients (this->get_solution(),
                     composition_gradients);
 
@@ -72,10 +78,11 @@ namespace aspect
                 // refining, so anything >1 should work. (note that the gradient
                 // itself scales like 1/h, so multiplying it with any factor h^s, s>1
                 // will yield convergence of the error indicators to zero as h->0)
-                this_indicator[idx] *= std::pow(cell->diameter(), power);
+                this_indicator[idx] *= cell_size_scaling;
+
+                indicators[idx] += static_cast<float>(composition_scaling_factors[c]) * this_indicator[idx];
               }
-          indicators.add(composition_scaling_factors[c], this_indicator);
-        }
+          }
     }
 
     template <int dim>
@@ -104,8 +104,13 @@ namespace aspect
         // Ac = QRc = b -> Q^TQRc = Rc =Q^Tb
         // A is a std::vector of Vectors(which are it's columns) so that we
         // create what the ImplicitQR class needs.
+        // Only the right hand sides of selected properties are allocated, since
+        // typically only a few of all particle properties are interpolated.
         std::vector<Vector<double>> A(n_matrix_columns, Vector<double>(n_particles));
-        std::vector<Vector<double>> b(n_particle_properties, Vector<double>(n_particles));
+        std::vector<Vector<double>> b(n_particle_properties);
+        for (unsigned int property_index = 0; property_index < n_particle_properties; ++property_index)
+          if (selected_properties[property_index] == true)
+            b[property_index].reinit(n_particles);
 
         unsigned int particle_index = 0;
         // The unit cell of deal.II is [0,1]^dim. The limiter needs a 'unit' cell of [-.5,.5]^dim.
@@ -202,16 +207,26 @@ namespace aspect
                                                             selected_properties,
                                                             found_cell);
 
-        std::vector<Vector<double>> QTb(n_particle_properties, Vector<double>(n_matrix_columns));
-        std::vector<Vector<double>> c(n_particle_properties, Vector<double>(n_matrix_columns));
-        for (unsigned int property_index = 0; property_index < n_particle_properties; ++property_index)
-          {
-            if (selected_properties[property_index] == true)
-              {
-                qr.multiply_with_QT(QTb[property_index], b[property_index]);
-                qr.solve(c[property_index], QTb[property_index]);
-              }
-          }
+        // The factorization of A is shared by all properties, so that each
+        // selected property only requires applying Q^T and a triangular solve.
+        std::vector<Vector<double>> c(n_particle_properties);
+        {
+          Vector<double> QTb(n_matrix_columns);
+          for (unsigned int property_index = 0; property_index < n_particle_properties; ++property_index)
+            {
+              if (selected_properties[property_index] == true)
+                {
+                  c[property_index].reinit(n_matrix_columns);
+                  qr.multiply_with_QT(QTb, b[property_index]);
+                  qr.solve(c[property_index], QTb);
+                }
+            }
+        }
+
+        // The reference coordinates of the positions are the same for all
+        // properties, so compute them only once.
+        const std::vector<Point<dim>> relative_support_point_locations = get_unit_positions(this->get_mapping(), found_cell, positions);
+
         const double half_h = .5;
         for (unsigned int property_index = 0; property_index < n_particle_properties; ++property_index)
           {
@@ -238,10 +253,9 @@ namespace aspect
                           c[property_index][i] *= slope_change_ratio;
                       }
                   }
-                std::size_t positions_index = 0;
-                for (typename std::vector<Point<dim>>::const_iterator itr = positions.begin(); itr != positions.end(); ++itr, ++positions_index)
+                for (unsigned int positions_index = 0; positions_index < positions.size(); ++positions_index)
                   {
-                    Point<dim> relative_support_point_location = this->get_mapping().transform_real_to_unit_cell(found_cell, *itr);
+                    Point<dim> relative_support_point_location = relative_support_point_locations[positions_index];
                     double interpolated_value = c[property_index][0];
                     for (unsigned int i = 1; i < n_matrix_columns; ++i)
                       {
@@ -21,6 +21,8 @@
 #include <aspect/particle/interpolator/interface.h>
 #include <aspect/simulator_access.h>
 
+#include <limits>
+
 namespace aspect
 {
   namespace Particle
@@ -52,6 +54,27 @@ namespace aspect
 
 
 
+      template <int dim>
+      std::vector<Point<dim>>
+      get_unit_positions (const Mapping<dim> &mapping,
+                          const typename parallel::distributed::Triangulation<dim>::active_cell_iterator &cell,
+                          const std::vector<Point<dim>> &positions)
+      {
+        std::vector<Point<dim>> unit_positions(positions.size());
+        mapping.transform_points_real_to_unit_cell(cell, positions, unit_positions);
+
+        // Positions that could not be inverted are marked by an infinite
+        // first coordinate. Repeat the transformation for them with the
+        // function that throws an exception describing the failure.
+        for (unsigned int i=0; i<positions.size(); ++i)
+          if (unit_positions[i][0] == std::numeric_limits<double>::infinity())
+            unit_positions[i] = mapping.transform_real_to_unit_cell(cell, positions[i]);
+
+        return unit_positions;
+      }
+
+
+
 // -------------------------------- Deal with registering models and automating
 // -------------------------------- their setup and selection at run time
 
@@ -180,7 +203,13 @@ namespace aspect
   \
   template \
   std::unique_ptr<Interface<dim>> \
-  create_particle_interpolator<dim> (ParameterHandler &prm);
+  create_particle_interpolator<dim> (ParameterHandler &prm); \
+  \
+  template \
+  std::vector<Point<dim>> \
+  get_unit_positions<dim> (const Mapping<dim> &, \
+                           const typename parallel::distributed::Triangulation<dim>::active_cell_iterator &, \
+                           const std::vector<Point<dim>> &);
 
       ASPECT_INSTANTIATE(INSTANTIATE)
 
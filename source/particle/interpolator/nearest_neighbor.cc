@@ -67,23 +67,36 @@ namespace aspect
         std::vector<double> temp(n_particle_properties, 0.0);
         std::vector<std::vector<double>> point_properties(positions.size(), temp);
 
+        // Copy the locations of all particles in this cell into a contiguous
+        // array once, rather than walking the particle handler again for
+        // every position.
+        std::vector<Point<dim>> particle_locations;
+        std::vector<typename ParticleHandler<dim>::particle_iterator> particles;
+        particle_locations.reserve(n_particles);
+        particles.reserve(n_particles);
+        for (typename ParticleHandler<dim>::particle_iterator particle = particle_range.begin();
+             particle != particle_range.end(); ++particle)
+          {
+            particle_locations.push_back(particle->get_location());
+            particles.push_back(particle);
+          }
+
         for (unsigned int pos_idx=0; pos_idx < positions.size(); ++pos_idx)
           {
             double minimum_distance = std::numeric_limits<double>::max();
             if (n_particles > 0)
               {
-                typename ParticleHandler<dim>::particle_iterator nearest_neighbor;
-                for (typename ParticleHandler<dim>::particle_iterator particle = particle_range.begin();
-                     particle != particle_range.end(); ++particle)
+                unsigned int nearest_neighbor = 0;
+                for (unsigned int particle_index = 0; particle_index < n_particles; ++particle_index)
                   {
-                    const double dist = (positions[pos_idx] - particle->get_location()).norm_square();
+                    const double dist = (positions[pos_idx] - particle_locations[particle_index]).norm_square();
                     if (dist < minimum_distance)
                       {
                         minimum_distance = dist;
-                        nearest_neighbor = particle;
+                        nearest_neighbor = particle_index;
                       }
                   }
-                const dealii::ArrayView<const double> neighbor_props = nearest_neighbor->get_properties();
+                const dealii::ArrayView<const double> neighbor_props = particles[nearest_neighbor]->get_properties();
                 for (unsigned int i = 0; i < n_particle_properties; ++i)
                   if (selected_properties[i])
                     point_properties[pos_idx][i] = neighbor_props[i];
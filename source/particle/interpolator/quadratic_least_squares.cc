@@ -360,8 +360,13 @@ namespace aspect
         // Ac = QRc = b -> Q^TQRc = Rc =Q^Tb
         // A is a std::vector of Vectors(which are it's columns) so that we
         // create what the ImplicitQR class needs.
+        // Only the right hand sides of selected properties are allocated, since
+        // typically only a few of all particle properties are interpolated.
         std::vector<Vector<double>> A(n_matrix_columns, Vector<double>(n_particles));
-        std::vector<Vector<double>> b(n_particle_properties, Vector<double>(n_particles));
+        std::vector<Vector<double>> b(n_particle_properties);
+        for (unsigned int property_index = 0; property_index < n_particle_properties; ++property_index)
+          if (selected_properties[property_index] == true)
+            b[property_index].reinit(n_particles);
 
         unsigned int particle_index = 0;
         // The unit cell of deal.II is [0, 1]^dim. The limiter needs a 'unit' cell of [-0.5, 0.5]^dim
@@ -476,14 +481,17 @@ namespace aspect
                                                             positions,
                                                             selected_properties,
                                                             found_cell);
-        std::vector<Vector<double>> QTb(n_particle_properties, Vector<double>(n_matrix_columns));
-        std::vector<Vector<double>> c(n_particle_properties, Vector<double>(n_matrix_columns));
+        // The factorization of A is shared by all properties, so that each
+        // selected property only requires applying Q^T and a triangular solve.
+        std::vector<Vector<double>> c(n_particle_properties);
+        Vector<double> QTb(n_matrix_columns);
         for (unsigned int property_index = 0; property_index < n_particle_properties; ++property_index)
           {
             if (selected_properties[property_index])
               {
-                qr.multiply_with_QT(QTb[property_index], b[property_index]);
-                qr.solve(c[property_index], QTb[property_index]);
+                c[property_index].reinit(n_matrix_columns);
+                qr.multiply_with_QT(QTb, b[property_index]);
+                qr.solve(c[property_index], QTb);
                 if (use_quadratic_least_squares_limiter[property_index])
                   {
 
@@ -505,10 +513,10 @@ namespace aspect
                   }
               }
           }
-        unsigned int index_positions = 0;
-        for (typename std::vector<Point<dim>>::const_iterator itr = positions.begin(); itr != positions.end(); ++itr, ++index_positions)
+        const std::vector<Point<dim>> unit_positions = get_unit_positions(this->get_mapping(), found_cell, positions);
+        for (unsigned int index_positions = 0; index_positions < positions.size(); ++index_positions)
           {
-            Point<dim> relative_support_point_location = this->get_mapping().transform_real_to_unit_cell(found_cell, *itr);
+            Point<dim> relative_support_point_location = unit_positions[index_positions];
             for (unsigned int d = 0; d < dim; ++d)
               relative_support_point_location[d] -= unit_offset;
             for (unsigned int property_index = 0; property_index < n_particle_properties; ++property_index)
@@ -335,7 +335,10 @@ namespace aspect
       template <int dim>
       inline
       Manager<dim>::Manager ()
-        = default;
+        :
+        combined_update_time (update_never),
+        combined_update_flags (update_default)
+      {}
 
 
 
@@ -364,6 +367,25 @@ namespace aspect
           {
             p->initialize();
           }
+
+        // Determine once which plugins need to be updated, and what
+        // data they need, rather than asking every plugin for every particle.
+        plugins_to_update.clear();
+        combined_update_time = update_never;
+        combined_update_flags = update_default;
+
+        unsigned int plugin_index = 0;
+        for (typename std::list<std::unique_ptr<Interface<dim>>>::const_iterator
+             p = property_list.begin(); p!=property_list.end(); ++p,++plugin_index)
+          {
+            if ((*p)->need_update() != update_never)
+              plugins_to_update.emplace_back(p->get(),
+                                             property_information.get_position_by_plugin_index(plugin_index));
+
+            combined_update_time = std::max(combined_update_time, (*p)->need_update());
+            combined_update_flags |= (*p)->get_needed_update_flags();
+          }
+        combined_update_flags = combined_update_flags & (update_default | update_values | update_gradients);
       }
 
 
@@ -557,15 +579,11 @@ namespace aspect
                                          const Vector<double> &solution,
                                          const std::vector<Tensor<1,dim>> &gradients) const
       {
-        unsigned int plugin_index = 0;
-        for (typename std::list<std::unique_ptr<Interface<dim>>>::const_iterator
-             p = property_list.begin(); p!=property_list.end(); ++p,++plugin_index)
-          {
-            (*p)->update_particle_property(property_information.get_position_by_plugin_index(plugin_index),
-                                           solution,
-                                           gradients,
-                                           particle);
-          }
+        for (const auto &plugin_and_position : plugins_to_update)
+          plugin_and_position.first->update_particle_property(plugin_and_position.second,
+                                                              solution,
+                                                              gradients,
+                                                              particle);
       }
 
 
@@ -574,12 +592,7 @@ namespace aspect
       UpdateTimeFlags
       Manager<dim>::need_update () const
       {
-        UpdateTimeFlags update = update_never;
-        for (const auto &p : property_list)
-          {
-            update = std::max(update, p->need_update());
-          }
-        return update;
+        return combined_update_time;
       }
 
 
@@ -588,13 +601,7 @@ namespace aspect
       UpdateFlags
       Manager<dim>::get_needed_update_flags () const
       {
-        UpdateFlags update = update_default;
-        for (const auto &p : property_list)
-          {
-            update |= p->get_needed_update_flags();
-          }
-
-        return (update & (update_default | update_values | update_gradients));
+        return combined_update_flags;
       }
 
 
@@ -28,6 +28,7 @@
 #include <deal.II/base/quadrature_lib.h>
 #include <deal.II/fe/fe_values.h>
 #include <deal.II/grid/grid_tools.h>
+#include <deal.II/grid/grid_tools_cache.h>
 
 #include <deal.II/matrix_free/fe_point_evaluation.h>
 #include <deal.II/fe/mapping_cartesian.h>
@@ -36,10 +37,24 @@
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 
+#include <algorithm>
+
 namespace aspect
 {
   namespace Particle
   {
+    namespace
+    {
+      /**
+       * The weight of a cell for the repartitioning of the mesh, before the
+       * weights of its particles are added. The particle weight is
+       * measured relative to this value.
+       */
+      const unsigned int base_cell_weight = 1000;
+    }
+
+
+
     template <int dim>
     World<dim>::World()
       = default;
@@ -68,6 +83,14 @@ namespace aspect
           return this->cell_weight(cell, status);
         });
 
+      particle_work_timer.reset();
+      if (particle_weight_is_measured())
+        this->get_triangulation().signals.pre_distributed_refinement.connect(
+          [&]()
+        {
+          this->update_measured_particle_weight();
+        });
+
       // Create a particle handler that stores the future particles.
       // If we restarted from a checkpoint we will fill this particle handler
       // later with its serialized variables and stored particles
@@ -346,6 +369,267 @@ namespace aspect
 
           particle_handler->update_cached_numbers();
         }
+
+      if ((particle_load_balancing & (ParticleLoadBalancing::merge_particles | ParticleLoadBalancing::split_particles))
+          && (this->get_timestep_number() % merge_and_split_interval == 0))
+        merge_and_split_particles();
+    }
+
+
+
+    template <int dim>
+    void
+    World<dim>::merge_and_split_particles()
+    {
+      // Splitting only starts at twice the tolerance used for merging. This
+      // hysteresis prevents particles in cells whose properties vary by about
+      // the tolerance from being split and merged again in every time step.
+      const double split_tolerance = 2. * interface_property_tolerance;
+
+      const auto properties_differ = [&] (const ArrayView<const double> &first,
+                                          const ArrayView<const double> &second) -> bool
+      {
+        for (const unsigned int component : interface_property_components)
+          if (std::abs(first[component] - second[component]) > split_tolerance)
+            return true;
+        return false;
+      };
+
+      // Merging never reduces the number of particles in a cell below this number.
+      const unsigned int minimum_particles_per_cell = std::max(min_particles_per_cell, 1U);
+
+      // Splitting creates new particles, which need globally unique ids.
+      // Therefore we first collect all of them, and create them once we
+      // know how many particles every process is going to create.
+      std::vector<std::tuple<typename Triangulation<dim>::active_cell_iterator,
+          Point<dim>,
+          std::vector<double>>> new_particles;
+
+      for (const auto &cell : this->get_dof_handler().active_cell_iterators())
+        if (cell->is_locally_owned())
+          {
+            const unsigned int n_particles_in_cell = particle_handler->n_particles_in_cell(cell);
+            if (n_particles_in_cell == 0)
+              continue;
+
+            const typename ParticleHandler<dim>::particle_iterator_range
+            particles_in_cell = particle_handler->particles_in_cell(cell);
+
+            double maximum_spread = 0.;
+            for (const unsigned int component : interface_property_components)
+              {
+                double minimum = std::numeric_limits<double>::max();
+                double maximum = std::numeric_limits<double>::lowest();
+                for (const auto &particle : particles_in_cell)
+                  {
+                    minimum = std::min(minimum, particle.get_properties()[component]);
+                    maximum = std::max(maximum, particle.get_properties()[component]);
+                  }
+
+                maximum_spread = std::max(maximum_spread, maximum - minimum);
+              }
+
+            // In uniform cells, merge pairs of nearest particles into one
+            // particle. The merged particle is placed at the weighted
+            // midpoint of the pair, carries the weighted average of the
+            // properties that can be averaged, and the sum of their
+            // weights. All other properties (e.g., ids, orientations, or
+            // initial positions) are those of the kept particle.
+            if (maximum_spread <= interface_property_tolerance
+                && (particle_load_balancing & ParticleLoadBalancing::merge_particles)
+                && n_particles_in_cell > minimum_particles_per_cell)
+              {
+                const unsigned int n_merges = std::min(n_particles_in_cell - minimum_particles_per_cell,
+                                                       n_particles_in_cell / 2);
+
+                std::vector<typename ParticleHandler<dim>::particle_iterator> particles;
+                particles.reserve(n_particles_in_cell);
+                for (auto particle = particles_in_cell.begin(); particle != particles_in_cell.end(); ++particle)
+                  particles.push_back(particle);
+
+                std::vector<bool> is_paired(n_particles_in_cell, false);
+                std::vector<unsigned int> particles_to_remove;
+                particles_to_remove.reserve(n_merges);
+
+                for (unsigned int i = 0; i < n_particles_in_cell && particles_to_remove.size() < n_merges; ++i)
+                  {
+                    if (is_paired[i])
+                      continue;
+
+                    const Point<dim> location = particles[i]->get_location();
+
+                    unsigned int nearest_particle = numbers::invalid_unsigned_int;
+                    double minimum_distance = std::numeric_limits<double>::max();
+                    for (unsigned int j = i+1; j < n_particles_in_cell; ++j)
+                      if (!is_paired[j])
+                        {
+                          const double distance = location.distance_square(particles[j]->get_location());
+                          if (distance < minimum_distance)
+                            {
+                              minimum_distance = distance;
+                              nearest_particle = j;
+                            }
+                        }
+
+                    if (nearest_particle == numbers::invalid_unsigned_int)
+                      break;
+
+                    is_paired[i] = true;
+                    is_paired[nearest_particle] = true;
+
+                    const typename ParticleHandler<dim>::particle_iterator kept_particle = particles[i];
+                    const typename ParticleHandler<dim>::particle_iterator merged_particle = particles[nearest_particle];
+
+                    const ArrayView<double> kept_properties = kept_particle->get_properties();
+                    const ArrayView<const double> merged_properties = merged_particle->get_properties();
+
+                    // Without a weight property (or if both weights vanish)
+                    // both particles contribute equally.
+                    double kept_weight = 1.;
+                    double merged_weight = 1.;
+                    if (merge_weight_component != numbers::invalid_unsigned_int
+                        && kept_properties[merge_weight_component] + merged_properties[merge_weight_component] > 0.)
+                      {
+                        kept_weight = kept_properties[merge_weight_component];
+                        merged_weight = merged_properties[merge_weight_component];
+                      }
+                    const double kept_fraction = kept_weight / (kept_weight + merged_weight);
+
+                    const Point<dim> merged_location = kept_fraction * location
+                                                       + (1. - kept_fraction) * merged_particle->get_location();
+                    const Point<dim> reference_location
+                      = this->get_mapping().transform_real_to_unit_cell(cell, merged_location);
+
+                    // For curved cells, the merged location may lie slightly
+                    // outside the cell. Keep the location of the kept particle
+                    // in this case.
+                    if (GeometryInfo<dim>::is_inside_unit_cell(reference_location))
+                      {
+                        kept_particle->set_location(merged_location);
+                        kept_particle->set_reference_location(reference_location);
+                      }
+
+                    for (unsigned int component = 0; component < kept_properties.size(); ++component)
+                      if (component == merge_weight_component)
+                        kept_properties[component] += merged_properties[component];
+                      else if (is_averaged_merge_component[component])
+                        kept_properties[component] = kept_fraction * kept_properties[component]
+                                                     + (1. - kept_fraction) * merged_properties[component];
+
+                    particles_to_remove.push_back(nearest_particle);
+                  }
+
+                // ParticleHandler::remove_particles() removes particles by
+                // swapping them with the last particle of their cell, so it
+                // needs the particles of a cell sorted by their index within
+                // the cell
+                std::sort(particles_to_remove.begin(), particles_to_remove.end());
+
+                std::vector<typename ParticleHandler<dim>::particle_iterator> sorted_particles_to_remove;
+                sorted_particles_to_remove.reserve(particles_to_remove.size());
+                for (const unsigned int index : particles_to_remove)
+                  sorted_particles_to_remove.push_back(particles[index]);
+
+                particle_handler->remove_particles(sorted_particles_to_remove);
+              }
+
+            // Close to interfaces, split particles whose nearest neighbor
+            // with different properties is in the same cell. The new particle
+            // is placed a quarter of the way towards that neighbor, i.e., on
+            // the side of the interface the original particle belongs to, and
+            // carries a copy of the properties of the original particle. The
+            // weight of the original particle is shared equally between both.
+            else if (maximum_spread > split_tolerance
+                     && (particle_load_balancing & ParticleLoadBalancing::split_particles)
+                     && n_particles_in_cell < max_particles_per_cell)
+              {
+                std::vector<Point<dim>> locations;
+                std::vector<ArrayView<double>> properties;
+                locations.reserve(n_particles_in_cell);
+                properties.reserve(n_particles_in_cell);
+                for (auto particle = particles_in_cell.begin(); particle != particles_in_cell.end(); ++particle)
+                  {
+                    locations.push_back(particle->get_location());
+                    properties.push_back(particle->get_properties());
+                  }
+
+                unsigned int n_splits = max_particles_per_cell - n_particles_in_cell;
+                for (unsigned int i = 0; i < n_particles_in_cell && n_splits > 0; ++i)
+                  {
+                    unsigned int nearest_different_particle = numbers::invalid_unsigned_int;
+                    double minimum_distance = std::numeric_limits<double>::max();
+                    for (unsigned int j = 0; j < n_particles_in_cell; ++j)
+                      if (properties_differ(properties[i], properties[j]))
+                        {
+                          const double distance = locations[i].distance_square(locations[j]);
+                          if (distance < minimum_distance)
+                            {
+                              minimum_distance = distance;
+                              nearest_different_particle = j;
+                            }
+                        }
+
+                    if (nearest_different_particle == numbers::invalid_unsigned_int)
+                      continue;
+
+                    if (merge_weight_component != numbers::invalid_unsigned_int)
+                      properties[i][merge_weight_component] *= 0.5;
+
+                    const Point<dim> new_location = locations[i] + 0.25 * (locations[nearest_different_particle] - locations[i]);
+                    new_particles.emplace_back(cell,
+                                               new_location,
+                                               std::vector<double>(properties[i].begin(), properties[i].end()));
+                    --n_splits;
+                  }
+              }
+          }
+
+      if (particle_load_balancing & ParticleLoadBalancing::split_particles)
+        {
+          particle_handler->update_cached_numbers();
+
+          const types::particle_index particles_to_add_locally = new_particles.size();
+          types::particle_index local_start_index = 0;
+
+          const int ierr = MPI_Scan(&particles_to_add_locally, &local_start_index, 1, DEAL_II_PARTICLE_INDEX_MPI_TYPE, MPI_SUM, this->get_mpi_communicator());
+          AssertThrowMPI(ierr);
+
+          local_start_index -= particles_to_add_locally;
+          types::particle_index local_next_particle_index = particle_handler->get_next_free_particle_index() + local_start_index;
+
+          const types::particle_index globally_generated_particles =
+            dealii::Utilities::MPI::sum(particles_to_add_locally,this->get_mpi_communicator());
+
+          AssertThrow (particle_handler->get_next_free_particle_index()
+                       <= std::numeric_limits<types::particle_index>::max() - globally_generated_particles,
+                       ExcMessage("There is no free particle index left to generate a new particle id. Please check if your "
+                                  "model generates unusually many new particles (by repeatedly deleting and regenerating particles), or "
+                                  "recompile deal.II with the DEAL_II_WITH_64BIT_INDICES option enabled, to use 64-bit integers for "
+                                  "particle ids."));
+
+          for (const auto &new_particle : new_particles)
+            {
+              const Point<dim> reference_location
+                = this->get_mapping().transform_real_to_unit_cell(std::get<0>(new_particle),
+                                                                  std::get<1>(new_particle));
+
+              // For curved cells, the new location may lie slightly outside
+              // the cell. Do not create a particle in this case.
+              if (GeometryInfo<dim>::is_inside_unit_cell(reference_location))
+                {
+                  const Particles::Particle<dim> particle (std::get<1>(new_particle),
+                                                           reference_location,
+                                                           local_next_particle_index);
+                  typename ParticleHandler<dim>::particle_iterator inserted_particle
+                    = particle_handler->insert_particle(particle, std::get<0>(new_particle));
+                  inserted_particle->set_properties(std::get<2>(new_particle));
+                }
+
+              ++local_next_particle_index;
+            }
+        }
+
+      particle_handler->update_cached_numbers();
     }
 
     template <int dim>
@@ -361,7 +645,6 @@ namespace aspect
       if (cell->is_active() && !cell->is_locally_owned())
         return 0;
 
-      const unsigned int base_weight = 1000;
       unsigned int n_particles_in_cell = 0;
       switch (status)
         {
@@ -396,7 +679,75 @@ namespace aspect
             Assert(false, ExcInternalError());
             break;
         }
-      return base_weight + n_particles_in_cell * particle_weight;
+      return base_cell_weight + n_particles_in_cell * particle_weight;
+    }
+
+
+
+    template <int dim>
+    void
+    World<dim>::update_measured_particle_weight()
+    {
+      // The cost of a cell is estimated from the time spent in the assembly
+      // of the field-based systems, which is dominated by local work and
+      // scales with the number of cells.
+      const std::map<std::string,double> section_times
+        = this->get_computing_timer().get_summary_data(TimerOutput::total_wall_time);
+      double assembly_time = 0.0;
+      for (const auto &section : section_times)
+        if (section.first.find("Assemble") == 0)
+          assembly_time += section.second;
+
+      const std::vector<double> local_values = {assembly_time - last_assembly_time,
+                                                static_cast<double>(this->get_triangulation().n_locally_owned_active_cells()),
+                                                particle_work_timer.wall_time(),
+                                                static_cast<double>(particle_handler->n_locally_owned_particles())
+                                               };
+      last_assembly_time = assembly_time;
+      particle_work_timer.reset();
+
+      std::vector<double> global_values (local_values.size());
+      Utilities::MPI::sum (local_values,
+                           this->get_mpi_communicator(),
+                           global_values);
+
+      // Keep the previous weight if there was nothing to measure, e.g.
+      // during the initial refinement steps.
+      if (global_values[0] > 0.0 && global_values[1] > 0.0
+          && global_values[2] > 0.0 && global_values[3] > 0.0)
+        {
+          const double cost_per_cell = global_values[0] / global_values[1];
+          const double cost_per_particle = global_values[2] / global_values[3];
+          particle_weight = static_cast<unsigned int>(std::round(base_cell_weight * cost_per_particle / cost_per_cell));
+        }
+    }
+
+
+
+    template <int dim>
+    unsigned int
+    World<dim>::get_particle_weight() const
+    {
+      return particle_weight;
+    }
+
+
+
+    template <int dim>
+    bool
+    World<dim>::particle_weight_is_measured() const
+    {
+      return (particle_load_balancing & ParticleLoadBalancing::repartition) && measure_particle_weight;
+    }
+
+
+
+    template <int dim>
+    double
+    World<dim>::get_local_load() const
+    {
+      return static_cast<double>(base_cell_weight) * this->get_triangulation().n_locally_owned_active_cells()
+             + static_cast<double>(particle_weight) * particle_handler->n_locally_owned_particles();
     }
 
 
@@ -544,6 +895,31 @@ namespace aspect
       for (auto particle = begin_particle; particle!=end_particle; ++particle)
         positions.push_back(particle->get_reference_location());
 
+      std::vector<Tensor<1,dim>> velocities;
+      std::vector<Tensor<1,dim>> old_velocities;
+      evaluate_velocities(cell,
+                          ArrayView<const Point<dim>>(positions.data(), positions.size()),
+                          evaluators,
+                          velocities,
+                          old_velocities);
+
+      integrator->local_integrate_step(begin_particle,
+                                       end_particle,
+                                       old_velocities,
+                                       velocities,
+                                       this->get_timestep());
+    }
+
+
+
+    template <int dim>
+    void
+    World<dim>::evaluate_velocities(const typename DoFHandler<dim>::active_cell_iterator &cell,
+                                    const ArrayView<const Point<dim>> &unit_positions,
+                                    internal::SolutionEvaluators<dim> &evaluators,
+                                    std::vector<Tensor<1,dim>> &velocities,
+                                    std::vector<Tensor<1,dim>> &old_velocities) const
+    {
       boost::container::small_vector<double, 100> solution_values(this->get_fe().dofs_per_cell);
       boost::container::small_vector<double, 100> old_solution_values(this->get_fe().dofs_per_cell);
 
@@ -560,22 +936,127 @@ namespace aspect
       auto &evaluator = evaluators.get_velocity_or_fluid_velocity_evaluator(use_fluid_velocity);
 
       auto &mapping_info = evaluators.get_mapping_info();
-      mapping_info.reinit(cell, {positions.data(),positions.size()});
+      mapping_info.reinit(cell, unit_positions);
       evaluator.evaluate({solution_values.data(),solution_values.size()},
                          EvaluationFlags::values);
 
-      std::vector<Tensor<1,dim>> velocities;
-      velocities.reserve(n_particles_in_cell);
-      for (unsigned int i=0; i<n_particles_in_cell; ++i)
+      velocities.clear();
+      velocities.reserve(unit_positions.size());
+      for (unsigned int i=0; i<unit_positions.size(); ++i)
         velocities.push_back(evaluator.get_value(i));
 
       evaluator.evaluate({old_solution_values.data(),old_solution_values.size()},
                          EvaluationFlags::values);
 
-      std::vector<Tensor<1,dim>> old_velocities;
-      old_velocities.reserve(n_particles_in_cell);
-      for (unsigned int i=0; i<n_particles_in_cell; ++i)
+      old_velocities.clear();
+      old_velocities.reserve(unit_positions.size());
+      for (unsigned int i=0; i<unit_positions.size(); ++i)
         old_velocities.push_back(evaluator.get_value(i));
+    }
+
+
+
+    template <int dim>
+    void
+    World<dim>::local_advect_particles_fused(const typename DoFHandler<dim>::active_cell_iterator &cell,
+                                             const typename ParticleHandler<dim>::particle_iterator &begin_particle,
+                                             const typename ParticleHandler<dim>::particle_iterator &end_particle,
+                                             internal::SolutionEvaluators<dim> &evaluators,
+                                             const GridTools::Cache<dim> &grid_cache,
+                                             const bool particles_are_sorted)
+    {
+      // If the particles have not moved since they were sorted, this is
+      // the same as the unfused version.
+      if (particles_are_sorted)
+        {
+          local_advect_particles(cell, begin_particle, end_particle, evaluators);
+          return;
+        }
+
+      const unsigned int n_particles_in_cell = particle_handler->n_particles_in_cell(cell);
+
+      // Find the cell around the current location of each particle. Most
+      // particles are still inside the cell that stores them, or in one of
+      // its neighbors, so use this cell as a hint for the search. Then
+      // group the particles by the cell they are located in, so that
+      // the velocity of all particles in one cell can be evaluated at once.
+      std::vector<typename Triangulation<dim>::active_cell_iterator> target_cells;
+      std::vector<std::vector<unsigned int>> target_particle_indices;
+      std::vector<std::vector<Point<dim>>> target_unit_positions;
+
+      // Particles whose intermediate location is not inside any cell
+      // this process knows about are evaluated at their location at the
+      // beginning of the time step. These particles will be removed or
+      // transferred when the particles are sorted at the end of the step.
+      std::vector<unsigned int> unlocated_particle_indices;
+      std::vector<Point<dim>> unlocated_unit_positions;
+
+      unsigned int particle_index = 0;
+      for (auto particle = begin_particle; particle!=end_particle; ++particle, ++particle_index)
+        {
+          const std::pair<typename Triangulation<dim>::active_cell_iterator, Point<dim>> cell_and_position
+            = GridTools::find_active_cell_around_point(grid_cache,
+                                                       particle->get_location(),
+                                                       cell);
+
+          if (cell_and_position.first.state() != IteratorState::valid
+              || cell_and_position.first->is_artificial())
+            {
+              unlocated_particle_indices.push_back(particle_index);
+              unlocated_unit_positions.push_back(particle->get_reference_location());
+              continue;
+            }
+
+          const unsigned int target = std::find(target_cells.begin(),
+                                                target_cells.end(),
+                                                cell_and_position.first) - target_cells.begin();
+          if (target == target_cells.size())
+            {
+              target_cells.push_back(cell_and_position.first);
+              target_particle_indices.emplace_back();
+              target_unit_positions.emplace_back();
+            }
+
+          target_particle_indices[target].push_back(particle_index);
+          target_unit_positions[target].push_back(cell_and_position.second);
+        }
+
+      std::vector<Tensor<1,dim>> velocities(n_particles_in_cell);
+      std::vector<Tensor<1,dim>> old_velocities(n_particles_in_cell);
+
+      std::vector<Tensor<1,dim>> target_velocities;
+      std::vector<Tensor<1,dim>> target_old_velocities;
+      for (unsigned int target = 0; target < target_cells.size(); ++target)
+        {
+          const typename DoFHandler<dim>::active_cell_iterator dof_cell (*target_cells[target],
+                                                                         &this->get_dof_handler());
+          evaluate_velocities(dof_cell,
+                              target_unit_positions[target],
+                              evaluators,
+                              target_velocities,
+                              target_old_velocities);
+
+          for (unsigned int i = 0; i < target_particle_indices[target].size(); ++i)
+            {
+              velocities[target_particle_indices[target][i]] = target_velocities[i];
+              old_velocities[target_particle_indices[target][i]] = target_old_velocities[i];
+            }
+        }
+
+      if (unlocated_particle_indices.size() > 0)
+        {
+          evaluate_velocities(cell,
+                              unlocated_unit_positions,
+                              evaluators,
+                              target_velocities,
+                              target_old_velocities);
+
+          for (unsigned int i = 0; i < unlocated_particle_indices.size(); ++i)
+            {
+              velocities[unlocated_particle_indices[i]] = target_velocities[i];
+              old_velocities[unlocated_particle_indices[i]] = target_old_velocities[i];
+            }
+        }
 
       integrator->local_integrate_step(begin_particle,
                                        end_particle,
@@ -1239,6 +1720,7 @@ namespace aspect
 
 
           // Loop over all cells and update the particles cell-wise
+          particle_work_timer.start();
           for (const auto &cell : this->get_dof_handler().active_cell_iterators())
             if (cell->is_locally_owned())
               {
@@ -1261,6 +1743,7 @@ namespace aspect
                   }
 
               }
+          particle_work_timer.stop();
         }
     }
 
@@ -1279,6 +1762,7 @@ namespace aspect
                                                                                 update_values);
 
         // Loop over all cells and advect the particles cell-wise
+        particle_work_timer.start();
         for (const auto &cell : this->get_dof_handler().active_cell_iterators())
           if (cell->is_locally_owned())
             {
@@ -1310,6 +1794,64 @@ namespace aspect
 
                 }
             }
+        particle_work_timer.stop();
+      }
+
+      {
+        TimerOutput::Scope timer_section(this->get_computing_timer(), "Particles: Sort");
+        // Find the cells that the particles moved to
+        particle_handler->sort_particles_into_subdomains_and_cells();
+      }
+    }
+
+
+
+    template <int dim>
+    void
+    World<dim>::advect_particles_fused()
+    {
+      {
+        TimerOutput::Scope timer_section(this->get_computing_timer(), "Particles: Advect");
+
+        std::unique_ptr<internal::SolutionEvaluators<dim>> evaluators =
+          std::make_unique<internal::SolutionEvaluatorsImplementation<dim, 0>>(*this,
+                                                                                update_values);
+
+        // The cache computes the connectivity information that is needed to
+        // search for cells around points only once it is first used. Create
+        // it anew for each time step, because the mapping may change
+        // between time steps if the mesh is deformed.
+        const GridTools::Cache<dim> grid_cache (this->get_triangulation(),
+                                                this->get_mapping());
+
+        particle_work_timer.start();
+
+        // Perform all integration steps while the particles stay in the
+        // cells they were sorted into at the beginning of the time step.
+        bool particles_are_sorted = true;
+        do
+          {
+            for (const auto &cell : this->get_dof_handler().active_cell_iterators())
+              if (cell->is_locally_owned())
+                {
+                  const typename ParticleHandler<dim>::particle_iterator_range
+                  particles_in_cell = particle_handler->particles_in_cell(cell);
+
+                  if (particles_in_cell.begin() != particles_in_cell.end())
+                    local_advect_particles_fused(cell,
+                                                 particles_in_cell.begin(),
+                                                 particles_in_cell.end(),
+                                                 *evaluators,
+                                                 grid_cache,
+                                                 particles_are_sorted);
+                }
+
+            particles_are_sorted = false;
+          }
+        // Keep calling the integrator until it indicates it is finished
+        while (integrator->new_integration_step());
+
+        particle_work_timer.stop();
       }
 
       {
@@ -1325,12 +1867,21 @@ namespace aspect
     void
     World<dim>::advance_timestep()
     {
-      do
-        {
-          advect_particles();
-        }
-      // Keep calling the integrator until it indicates it is finished
-      while (integrator->new_integration_step());
+      // Fusing the integration steps requires the fast evaluation of the
+      // solution with FEPointEvaluation, which is only available for
+      // certain mappings.
+      const bool use_fast_path = (dynamic_cast<const MappingQGeneric<dim> *>(&this->get_mapping()) != nullptr ||
+                                  dynamic_cast<const MappingCartesian<dim> *>(&this->get_mapping()) != nullptr);
+
+      if (fuse_integration_steps && use_fast_path)
+        advect_particles_fused();
+      else
+        do
+          {
+            advect_particles();
+          }
+        // Keep calling the integrator until it indicates it is finished
+        while (integrator->new_integration_step());
 
       apply_particle_per_cell_bounds();
 
@@ -1380,9 +1931,32 @@ namespace aspect
         {
           prm.declare_entry ("Load balancing strategy", "repartition",
                              Patterns::MultipleSelection ("none|remove particles|add particles|"
-                                                          "remove and add particles|repartition"),
+                                                          "remove and add particles|repartition|"
+                                                          "merge particles|split particles"),
                              "Strategy that is used to balance the computational "
-                             "load across processors for adaptive meshes.");
+                             "load across processors for adaptive meshes. "
+                             "The strategies `merge particles' and `split particles' "
+                             "adapt the number of particles to where property "
+                             "information is needed: In cells in which none of the "
+                             "'Interface properties' varies by more than the "
+                             "'Interface property tolerance', pairs of particles are "
+                             "merged into one particle until the cell contains no "
+                             "more than 'Minimum particles per cell' (but at least one) "
+                             "particles. Each particle is merged with its nearest "
+                             "neighbor, and the merged particle is placed at their "
+                             "midpoint and carries the average of all of their "
+                             "properties; see 'Merge weight property' for how these "
+                             "averages are weighted. In cells in which one of the "
+                             "'Interface properties' varies by more than twice the "
+                             "'Interface property tolerance', particles close to "
+                             "an interface are split, i.e., a copy of the particle is "
+                             "placed a quarter of the way towards the nearest particle "
+                             "with different properties, until the cell contains "
+                             "'Maximum particles per cell' particles. Particles in "
+                             "cells in between these two thresholds are left unchanged, "
+                             "so that particles are not merged and split again in every "
+                             "time step. Both strategies are applied every "
+                             "'Time steps between merging and splitting' time steps.");
           prm.declare_entry ("Minimum particles per cell", "0",
                              Patterns::Integer (0),
                              "Lower limit for particle number per cell. This limit is "
@@ -1419,7 +1993,85 @@ namespace aspect
                              "expensive integrator and more expensive properties a larger "
                              "particle weight is recommended. Before adding the weights "
                              "of particles, each cell already carries a weight of 1000 to "
-                             "account for the cost of field-based computations.");
+                             "account for the cost of field-based computations. "
+                             "If 'Measure particle weight' is set, this value is "
+                             "only used until the first measurement is available.");
+          prm.declare_entry ("Measure particle weight", "false",
+                             Patterns::Bool (),
+                             "Whether to determine the 'Particle weight' automatically "
+                             "from measured run times if the `repartition' particle load "
+                             "balancing strategy is selected. Before every repartitioning "
+                             "of the mesh, the time spent updating and advecting particles "
+                             "per particle is compared to the time spent assembling the "
+                             "field-based systems per cell, and the particle weight is set "
+                             "to the ratio of these two costs times the weight of a cell. "
+                             "This accounts for the actual cost of the selected integrator "
+                             "and particle properties, which can differ by orders of "
+                             "magnitude between models. The resulting particle weight "
+                             "and load balance are reported by the `load balance "
+                             "statistics' postprocessor.");
+          prm.declare_entry ("Interface properties", "",
+                             Patterns::List (Patterns::Anything()),
+                             "A list of names of particle property fields that "
+                             "determine where particles are merged and split, if the "
+                             "`merge particles' or `split particles' load balancing "
+                             "strategies are selected. Typically these are the "
+                             "properties that carry compositional fields, or the "
+                             "integrated strain.");
+          prm.declare_entry ("Interface property tolerance", "0.01",
+                             Patterns::Double (0.),
+                             "The largest difference between values of the "
+                             "'Interface properties' for which two particles are "
+                             "considered to belong to the same material.");
+          prm.declare_entry ("Merge weight property", "",
+                             Patterns::Anything(),
+                             "The name of a particle property field with a single "
+                             "component that describes the weight (for example the "
+                             "volume or mass) a particle represents, if the `merge "
+                             "particles' load balancing strategy is selected. When "
+                             "two particles are merged, the location and the averaged "
+                             "properties (see 'Merge averaged properties') of the "
+                             "merged particle are the averages of the two particles "
+                             "weighted by this property, and the merged particle "
+                             "carries the sum of both weights. When a particle "
+                             "is split, its weight is shared equally between the two "
+                             "resulting particles. If this parameter is empty, both "
+                             "particles are weighted equally, i.e., the merged particle "
+                             "is placed at the midpoint and carries the arithmetic "
+                             "mean of the averaged properties.");
+          prm.declare_entry ("Merge averaged properties", "",
+                             Patterns::List (Patterns::Anything()),
+                             "A list of names of particle property fields, in addition "
+                             "to the 'Interface properties', whose values are averaged "
+                             "when two particles are merged. Only list properties for "
+                             "which an average is meaningful, such as compositions or "
+                             "temperatures. All other properties of the merged particle, "
+                             "for example ids, orientations, or initial positions, are "
+                             "those of the particle that is kept.");
+          prm.declare_entry ("Time steps between merging and splitting", "1",
+                             Patterns::Integer (1),
+                             "The number of time steps between two applications of "
+                             "the `merge particles' and `split particles' load "
+                             "balancing strategies. Larger values reduce the cost of "
+                             "these strategies and the amount of averaging of "
+                             "particle properties by repeated merging.");
+          prm.declare_entry ("Fuse integration steps", "false",
+                             Patterns::Bool (),
+                             "Whether to perform all steps of a multi-step particle "
+                             "integration scheme (such as `rk2' or `rk4') without sorting "
+                             "the particles into the cells that contain their intermediate "
+                             "positions, and without transferring them to other processes "
+                             "in between. If true, the cell around the intermediate position "
+                             "of each particle is found by searching the neighborhood of the "
+                             "cell that stores the particle, and particles are only sorted "
+                             "once at the end of each time step. This reduces the amount "
+                             "of communication considerably for multi-step schemes. "
+                             "Intermediate positions that are not inside any cell that "
+                             "is known to the current process use the velocity at the "
+                             "position of the particle at the beginning of the time step. "
+                             "This option is only used if the mapping allows for the "
+                             "fast evaluation of the solution at particle positions, "
+                             "i.e., for Cartesian and polynomial mappings.");
           prm.declare_entry ("Update ghost particles", "false",
                              Patterns::Bool (),
                              "Some particle interpolation algorithms require knowledge "
@@ -1471,8 +2123,16 @@ namespace aspect
                                  "that is smaller than or equal to the 'Maximum particles per cell' parameter."));
 
           particle_weight = prm.get_integer("Particle weight");
+          measure_particle_weight = prm.get_bool("Measure particle weight");
+          last_assembly_time = 0.0;
 
           update_ghost_particles = prm.get_bool("Update ghost particles");
+          fuse_integration_steps = prm.get_bool("Fuse integration steps");
+          interface_property_names = Utilities::split_string_list(prm.get("Interface properties"));
+          interface_property_tolerance = prm.get_double("Interface property tolerance");
+          merge_weight_property_name = prm.get("Merge weight property");
+          merge_averaged_property_names = Utilities::split_string_list(prm.get("Merge averaged properties"));
+          merge_and_split_interval = prm.get_integer("Time steps between merging and splitting");
 
           const std::vector<std::string> strategies = Utilities::split_string_list(prm.get ("Load balancing strategy"));
           AssertThrow(Utilities::has_unique_entries(strategies),
@@ -1492,6 +2152,10 @@ namespace aspect
                 particle_load_balancing = typename ParticleLoadBalancing::Kind(particle_load_balancing | ParticleLoadBalancing::remove_and_add_particles);
               else if (*strategy == "repartition")
                 particle_load_balancing = typename ParticleLoadBalancing::Kind(particle_load_balancing | ParticleLoadBalancing::repartition);
+              else if (*strategy == "merge particles")
+                particle_load_balancing = typename ParticleLoadBalancing::Kind(particle_load_balancing | ParticleLoadBalancing::merge_particles);
+              else if (*strategy == "split particles")
+                particle_load_balancing = typename ParticleLoadBalancing::Kind(particle_load_balancing | ParticleLoadBalancing::split_particles);
               else if (*strategy == "none")
                 {
                   particle_load_balancing = ParticleLoadBalancing::no_balancing;
@@ -1528,6 +2192,54 @@ namespace aspect
       property_manager->parse_parameters(prm);
       property_manager->initialize();
 
+      // Now that the particle properties are known, find the
+      // components that determine where particles are merged and split.
+      if (particle_load_balancing & (ParticleLoadBalancing::merge_particles | ParticleLoadBalancing::split_particles))
+        {
+          AssertThrow(interface_property_names.size() > 0,
+                      ExcMessage("The `merge particles' and `split particles' particle load balancing "
+                                 "strategies require at least one entry in the 'Interface properties' "
+                                 "parameter."));
+
+          const Property::ParticlePropertyInformation &property_information = property_manager->get_data_info();
+          interface_property_components.clear();
+          for (const auto &name : interface_property_names)
+            {
+              AssertThrow(property_information.fieldname_exists(name),
+                          ExcMessage("The particle property field <" + name + "> listed in the "
+                                     "'Interface properties' parameter does not exist."));
+
+              const unsigned int first_component = property_information.get_position_by_field_name(name);
+              for (unsigned int c = 0; c < property_information.get_components_by_field_name(name); ++c)
+                interface_property_components.push_back(first_component + c);
+            }
+
+          merge_weight_component = numbers::invalid_unsigned_int;
+          if (merge_weight_property_name != "")
+            {
+              AssertThrow(property_information.fieldname_exists(merge_weight_property_name)
+                          && property_information.get_components_by_field_name(merge_weight_property_name) == 1,
+                          ExcMessage("The particle property field <" + merge_weight_property_name + "> given in the "
+                                     "'Merge weight property' parameter does not exist, or has more than one component."));
+
+              merge_weight_component = property_information.get_position_by_field_name(merge_weight_property_name);
+            }
+
+          is_averaged_merge_component.assign(property_information.n_components(), false);
+          for (const unsigned int component : interface_property_components)
+            is_averaged_merge_component[component] = true;
+          for (const auto &name : merge_averaged_property_names)
+            {
+              AssertThrow(property_information.fieldname_exists(name),
+                          ExcMessage("The particle property field <" + name + "> listed in the "
+                                     "'Merge averaged properties' parameter does not exist."));
+
+              const unsigned int first_component = property_information.get_position_by_field_name(name);
+              for (unsigned int c = 0; c < property_information.get_components_by_field_name(name); ++c)
+                is_averaged_merge_component[first_component + c] = true;
+            }
+        }
+
       // Create an integrator object depending on the specified parameter
       integrator = Integrator::create_particle_integrator<dim> (prm);
       if (SimulatorAccess<dim> *sim = dynamic_cast<SimulatorAccess<dim>*>(integrator.get()))
@@ -76,6 +76,22 @@ namespace aspect
           statistics.add_value ("Minimal local particle to cell ratio", particle_to_cell_ratio.min);
           statistics.add_value ("Maximal local particle to cell ratio", particle_to_cell_ratio.max);
           statistics.add_value ("Average local particle to cell ratio", particle_to_cell_ratio.avg);
+
+          // The weighted load is the quantity that is balanced when the mesh
+          // is repartitioned, so the ratio of its maximum and average
+          // describes the load imbalance that was actually achieved.
+          const Particle::World<dim> &particle_world = particle_postprocessor.get_particle_world();
+          if (particle_world.particle_weight_is_measured())
+            {
+              const dealii::Utilities::MPI::MinMaxAvg weighted_load
+                = dealii::Utilities::MPI::min_max_avg(particle_world.get_local_load(),
+                                                      this->get_mpi_communicator());
+
+              statistics.add_value ("Particle weight",
+                                    particle_world.get_particle_weight());
+              statistics.add_value ("Maximal to average weighted load ratio",
+                                    (weighted_load.avg > 0.0) ? weighted_load.max / weighted_load.avg : 1.0);
+            }
         }
 
       std::ostringstream output;
@@ -107,7 +123,12 @@ namespace aspect
                                   "maximal, average, and minimum number of particles across "
                                   "all ranks, and maximal, average, and minimal ratio "
                                   "between local number of particles and local number "
-                                  "of cells across all processes. All of these numbers "
+                                  "of cells across all processes. If the particle weight is "
+                                  "measured, it also reports the "
+                                  "weight of a particle that is used when repartitioning "
+                                  "the mesh, and the ratio between the maximal and the "
+                                  "average weighted load of a process, which is the "
+                                  "load imbalance the repartitioning achieves. All of these numbers "
                                   "can be useful to assess the load balance between "
                                   "different MPI ranks, as the difference between the "
                                   "minimal and maximal load should be as small as "
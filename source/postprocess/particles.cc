@@ -26,21 +26,71 @@
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 
+#include <cstdint>
 #include <cstdio>
+#include <iomanip>
+#include <limits>
 #include <unistd.h>
 
+#ifdef DEAL_II_WITH_ZLIB
+#  include <zlib.h>
+#endif
+
 namespace aspect
 {
   namespace Postprocess
   {
     namespace internal
     {
+      namespace
+      {
+        /**
+         * Return whether the particle property field with the name
+         * @p field_name is excluded from output by any of the entries of
+         * @p exclude_output_properties.
+         */
+        bool
+        is_excluded_from_output (const std::string &field_name,
+                                 const std::vector<std::string> &exclude_output_properties)
+        {
+          for (const auto &property : exclude_output_properties)
+            if (field_name.find(property) != std::string::npos)
+              return true;
+
+          return false;
+        }
+      }
+
+
+
+      bool
+      is_selected_for_output (const types::particle_index particle_id,
+                              const double output_fraction)
+      {
+        if (output_fraction >= 1.0)
+          return true;
+
+        // Compute a pseudo-random number in [0,1) from the particle id, using
+        // the finalizer of the 'splitmix64' generator as hash function. This
+        // distributes consecutive ids uniformly over the interval.
+        std::uint64_t z = static_cast<std::uint64_t>(particle_id) + 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z = z ^ (z >> 31);
+
+        // Use the upper 53 bits, which can be represented exactly as a double
+        return static_cast<double>(z >> 11) / 9007199254740992. < output_fraction;
+      }
+
+
+
       template<int dim>
       void
       ParticleOutput<dim>::build_patches(const dealii::Particles::ParticleHandler<dim> &particle_handler,
                                          const aspect::Particle::Property::ParticlePropertyInformation &property_information,
                                          const std::vector<std::string> &exclude_output_properties,
-                                         const bool only_group_3d_vectors)
+                                         const bool only_group_3d_vectors,
+                                         const double output_fraction)
       {
         // First store the names of the data fields that should be written
         dataset_names.reserve(property_information.n_components()+1);
@@ -78,15 +128,7 @@ namespace aspect
                                               dim == 3 && n_components == 3);
 
                 // Determine if this field should be excluded, if so, skip it
-                bool exclude_property = false;
-                for (const auto &property : exclude_output_properties)
-                  if (field_name.find(property) != std::string::npos)
-                    {
-                      exclude_property = true;
-                      break;
-                    }
-
-                if (exclude_property == false)
+                if (is_excluded_from_output(field_name, exclude_output_properties) == false)
                   {
                     // For each component record its name and position in output vector
                     for (unsigned int component_index=0; component_index<n_components; ++component_index)
@@ -113,27 +155,34 @@ namespace aspect
               }
           }
 
-        // Now build the actual patch data
-        patches.resize(particle_handler.n_locally_owned_particles());
-        typename dealii::Particles::ParticleHandler<dim>::particle_iterator particle = particle_handler.begin();
+        // Now build the actual patch data for all particles selected for output
+        patches.clear();
+        if (output_fraction >= 1.0)
+          patches.reserve(particle_handler.n_locally_owned_particles());
 
-        for (unsigned int i=0; particle != particle_handler.end(); ++particle, ++i)
+        for (const auto &particle : particle_handler)
           {
-            patches[i].vertices[0] = particle->get_location();
-            patches[i].patch_index = i;
+            if (is_selected_for_output(particle.get_id(), output_fraction) == false)
+              continue;
+
+            patches.emplace_back();
+            DataOutBase::Patch<0,dim> &patch = patches.back();
 
-            patches[i].data.reinit(dataset_names.size(),1);
+            patch.vertices[0] = particle.get_location();
+            patch.patch_index = patches.size()-1;
 
-            patches[i].data(0,0) = particle->get_id();
+            patch.data.reinit(dataset_names.size(),1);
 
-            if (particle->has_properties())
+            patch.data(0,0) = particle.get_id();
+
+            if (particle.has_properties())
               {
-                const ArrayView<const double> properties = particle->get_properties();
+                const ArrayView<const double> properties = particle.get_properties();
 
                 for (unsigned int property_index = 0; property_index < properties.size(); ++property_index)
                   {
                     if (property_index_to_output_index[property_index] > 0)
-                      patches[i].data(property_index_to_output_index[property_index],0) = properties[property_index];
+                      patch.data(property_index_to_output_index[property_index],0) = properties[property_index];
                   }
               }
           }
@@ -174,7 +223,9 @@ namespace aspect
       last_output_time (std::numeric_limits<double>::quiet_NaN())
       ,output_file_number (numbers::invalid_unsigned_int),
       group_files(0),
-      write_in_background_thread(false)
+      write_in_background_thread(false),
+      output_fraction(1.0),
+      compress_columnar_output(false)
     {}
 
 
@@ -316,6 +367,193 @@ namespace aspect
       DataOutBase::write_visit_record (global_visit_master, times_and_output_file_names);
     }
 
+    template <int dim>
+    void
+    Particles<dim>::write_columnar_output (const std::string &filename) const
+    {
+      const MPI_Comm comm = this->get_mpi_communicator();
+      const unsigned int my_id = Utilities::MPI::this_mpi_process(comm);
+      const unsigned int n_processes = Utilities::MPI::n_mpi_processes(comm);
+
+      const Particle::World<dim> &world = this->get_particle_world();
+      const Particle::Property::ParticlePropertyInformation &property_information
+        = world.get_property_manager().get_data_info();
+
+      // Determine which particle property components we write, and
+      // how to call them. The first dim+1 columns always contain the id and
+      // the location of the particles.
+      std::vector<std::string> column_names = {"id"};
+      for (unsigned int d=0; d<dim; ++d)
+        column_names.emplace_back("position_" + Utilities::to_string(d));
+
+      std::vector<unsigned int> output_property_indices;
+      if (std::find(exclude_output_properties.begin(),
+                    exclude_output_properties.end(),
+                    "all")
+          == exclude_output_properties.end())
+        for (unsigned int field_index = 0; field_index < property_information.n_fields(); ++field_index)
+          {
+            const std::string field_name = property_information.get_field_name_by_index(field_index);
+            if (internal::is_excluded_from_output(field_name, exclude_output_properties))
+              continue;
+
+            const unsigned int n_components = property_information.get_components_by_field_index(field_index);
+            const unsigned int field_position = property_information.get_position_by_field_index(field_index);
+            for (unsigned int component_index=0; component_index<n_components; ++component_index)
+              {
+                column_names.push_back(n_components == 1
+                                       ?
+                                       field_name
+                                       :
+                                       field_name + "_" + Utilities::to_string(component_index));
+                output_property_indices.push_back(field_position + component_index);
+              }
+          }
+
+      const unsigned int n_columns = column_names.size();
+
+      // Copy the data of all selected particles into one array per column.
+      // We store the ids as integers and everything else as doubles.
+      std::vector<std::uint64_t> ids;
+      std::vector<std::vector<double>> columns(n_columns-1);
+      for (const auto &particle : world.get_particle_handler())
+        {
+          if (internal::is_selected_for_output(particle.get_id(), output_fraction) == false)
+            continue;
+
+          ids.push_back(particle.get_id());
+
+          const Point<dim> location = particle.get_location();
+          for (unsigned int d=0; d<dim; ++d)
+            columns[d].push_back(location[d]);
+
+          if (output_property_indices.size() > 0)
+            {
+              const ArrayView<const double> properties = particle.get_properties();
+              for (unsigned int i=0; i<output_property_indices.size(); ++i)
+                columns[dim+i].push_back(properties[output_property_indices[i]]);
+            }
+        }
+
+      // Now turn the columns into blocks of bytes, compressing them if
+      // requested
+      std::vector<std::string> blocks;
+      blocks.reserve(n_columns);
+      blocks.emplace_back(reinterpret_cast<const char *>(ids.data()),
+                          ids.size() * sizeof(std::uint64_t));
+      for (const auto &column : columns)
+        blocks.emplace_back(reinterpret_cast<const char *>(column.data()),
+                            column.size() * sizeof(double));
+
+      if (compress_columnar_output)
+        {
+#ifdef DEAL_II_WITH_ZLIB
+          for (auto &block : blocks)
+            {
+              uLongf compressed_data_length = compressBound (block.size());
+              std::vector<char> compressed_data (compressed_data_length);
+              const int err = compress2 (reinterpret_cast<Bytef *>(compressed_data.data()),
+                                         &compressed_data_length,
+                                         reinterpret_cast<const Bytef *>(block.data()),
+                                         block.size(),
+                                         Z_BEST_SPEED);
+              AssertThrow (err == Z_OK,
+                           ExcMessage("Compressing the particle output data failed with error code <"
+                                      + Utilities::int_to_string(err) + ">."));
+              block.assign (compressed_data.data(), compressed_data_length);
+            }
+#else
+          AssertThrow (false,
+                       ExcMessage ("You need to have deal.II configured with the `libz' "
+                                   "option to support compressed particle output, but deal.II "
+                                   "did not detect its presence when you called `cmake'."));
+#endif
+        }
+
+      // Every process knows everything it needs to create the header, so
+      // create it everywhere to know where the index starts.
+      const std::uint16_t endianness_test = 1;
+      std::ostringstream header;
+      header << "ASPECT columnar particle output\n"
+             << "version: 1\n"
+             << "dimension: " << dim << '\n'
+             << "time: " << std::setprecision(16)
+             << (this->convert_output_to_years() ? this->get_time() / year_in_seconds : this->get_time()) << '\n'
+             << "timestep: " << this->get_timestep_number() << '\n'
+             << "number of particles: " << Utilities::MPI::sum(static_cast<std::uint64_t>(ids.size()), comm) << '\n'
+             << "number of blocks: " << n_processes << '\n'
+             << "compression: " << (compress_columnar_output ? "zlib" : "none") << '\n'
+             << "byte order: " << (*reinterpret_cast<const char *>(&endianness_test) == 1 ? "little endian" : "big endian") << '\n'
+             << "number of columns: " << n_columns << '\n';
+      // One line per column with its data type and name. The name comes
+      // last because names of particle properties may contain spaces.
+      for (unsigned int c=0; c<n_columns; ++c)
+        header << (c == 0 ? "uint64 " : "float64 ") << column_names[c] << '\n';
+      header << "end of header\n";
+      const std::string header_string = header.str();
+
+      // Then compute where in the file each process writes its row of the
+      // index, and its block of data.
+      std::vector<std::uint64_t> index_row (n_columns+1);
+      index_row[0] = ids.size();
+      std::uint64_t local_data_size = 0;
+      for (unsigned int c=0; c<n_columns; ++c)
+        {
+          index_row[c+1] = blocks[c].size();
+          local_data_size += blocks[c].size();
+        }
+
+      std::uint64_t local_data_offset = 0;
+      int ierr = MPI_Exscan(&local_data_size, &local_data_offset, 1, MPI_UINT64_T, MPI_SUM, comm);
+      AssertThrowMPI(ierr);
+      // The result of MPI_Exscan is undefined on process zero
+      if (my_id == 0)
+        local_data_offset = 0;
+
+      const MPI_Offset index_offset = header_string.size() + my_id * index_row.size() * sizeof(std::uint64_t);
+      const MPI_Offset data_offset = header_string.size()
+                                     + n_processes * index_row.size() * sizeof(std::uint64_t)
+                                     + local_data_offset;
+
+      std::string local_data;
+      local_data.reserve(local_data_size);
+      for (const auto &block : blocks)
+        local_data += block;
+
+      AssertThrow(local_data.size() < static_cast<std::size_t>(std::numeric_limits<int>::max()),
+                  ExcMessage("The particle output data of one process exceeds the maximal size "
+                             "that can be written in one MPI I/O operation."));
+
+      // Finally write everything using collective MPI I/O operations
+      MPI_File fh;
+      ierr = MPI_File_open(comm, filename.c_str(),
+                           MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                           MPI_INFO_NULL, &fh);
+      AssertThrow(ierr == MPI_SUCCESS, ExcMessage("Unable to open file for writing: " + filename + "."));
+
+      // Truncate the file in case it already existed
+      ierr = MPI_File_set_size(fh, 0);
+      AssertThrowMPI(ierr);
+
+      ierr = MPI_File_write_at_all(fh, 0, header_string.data(),
+                                   (my_id == 0 ? static_cast<int>(header_string.size()) : 0),
+                                   MPI_CHAR, MPI_STATUS_IGNORE);
+      AssertThrowMPI(ierr);
+
+      ierr = MPI_File_write_at_all(fh, index_offset, index_row.data(),
+                                   static_cast<int>(index_row.size()), MPI_UINT64_T, MPI_STATUS_IGNORE);
+      AssertThrowMPI(ierr);
+
+      ierr = MPI_File_write_at_all(fh, data_offset, local_data.data(),
+                                   static_cast<int>(local_data.size()), MPI_CHAR, MPI_STATUS_IGNORE);
+      AssertThrowMPI(ierr);
+
+      ierr = MPI_File_close(&fh);
+      AssertThrowMPI(ierr);
+    }
+
+
+
     template <int dim>
     std::pair<std::string,std::string>
     Particles<dim>::execute (TableHandler &statistics)
@@ -353,13 +591,17 @@ namespace aspect
       else
         ++output_file_number;
 
-      // Create the particle output
+      // Create the particle output. The 'columnar' format does not need
+      // the patches, so only build them if any other format is selected.
       const bool output_hdf5 = std::find(output_formats.begin(), output_formats.end(),"hdf5") != output_formats.end();
+      const bool output_columnar_only = (output_formats.size() == 1 && output_formats[0] == "columnar");
       internal::ParticleOutput<dim> data_out;
-      data_out.build_patches(world.get_particle_handler(),
-                             world.get_property_manager().get_data_info(),
-                             exclude_output_properties,
-                             output_hdf5);
+      if (output_columnar_only == false)
+        data_out.build_patches(world.get_particle_handler(),
+                               world.get_property_manager().get_data_info(),
+                               exclude_output_properties,
+                               output_hdf5,
+                               output_fraction);
 
       // Now prepare everything for writing the output and choose output format
       std::string particle_file_prefix = "particles-" + Utilities::int_to_string (output_file_number, 5);
@@ -373,7 +615,12 @@ namespace aspect
           // this case was handled above
           Assert(output_format != "none", ExcInternalError());
 
-          if (output_format == "hdf5")
+          if (output_format == "columnar")
+            {
+              write_columnar_output (this->get_output_directory() + "particles/"
+                                     + particle_file_prefix + ".columns");
+            }
+          else if (output_format == "hdf5")
             {
               const std::string particle_file_name = "particles/" + particle_file_prefix + ".h5";
               const std::string xdmf_filename = "particles.xdmf";
@@ -612,11 +859,39 @@ namespace aspect
           // in deal.II was implemented. It is nearly identical to the gnuplot format, thus
           // we now simply replace "ascii" by "gnuplot" should it be selected.
           prm.declare_entry ("Data output format", "vtu",
-                             Patterns::MultipleSelection (DataOutBase::get_output_format_names ()+"|ascii"),
+                             Patterns::MultipleSelection (DataOutBase::get_output_format_names ()+"|ascii|columnar"),
                              "A comma separated list of file formats to be used for graphical "
                              "output. The list of possible output formats that can be given "
                              "here is documented in the appendix of the manual where the current "
-                             "parameter is described.");
+                             "parameter is described. In addition to the formats supported by "
+                             "deal.II, the `columnar' format writes the ids, locations, and "
+                             "properties of all particles of one output step into a single "
+                             "binary file in which all values of one quantity are stored "
+                             "contiguously. This format avoids the creation of intermediate "
+                             "data structures and is therefore considerably faster and less "
+                             "memory intensive for models with many particles.\n\n"
+                             "A file in the `columnar' format consists of three parts. It "
+                             "starts with a text header, whose first line is `ASPECT columnar "
+                             "particle output'. It is followed by lines of the form `key: value' "
+                             "for the keys `version', `dimension', `time', `timestep', "
+                             "`number of particles', `number of blocks', `compression' "
+                             "(`none' or `zlib'), `byte order' (`little endian' or `big "
+                             "endian'), and `number of columns'. Then follows one line per "
+                             "column of the form `type name', where the type is `uint64' for "
+                             "the first column, which contains the particle ids, and `float64' "
+                             "for all other columns, which contain the coordinates of the "
+                             "particle locations and the particle properties. The header ends "
+                             "with the line `end of header'. The second part is an index with "
+                             "one row per block, each of which consists of (number of columns + 1) "
+                             "unsigned 64 bit integers: the number of particles in the block, "
+                             "followed by the size in bytes of each of the columns of the "
+                             "block. The third part contains the blocks in the same order as "
+                             "the index, and each block contains its columns one after the "
+                             "other. Every process writes one block. If compression is "
+                             "selected, each column of each block is compressed separately "
+                             "with zlib. All binary data uses the byte order given in the "
+                             "header. The script `contrib/python/scripts/read_columnar_particles.py' "
+                             "reads files in this format.");
 
           prm.declare_entry ("Number of grouped files", "16",
                              Patterns::Integer(0),
@@ -643,6 +918,23 @@ namespace aspect
                              "set to a non-empty string it will be interpreted as a "
                              "temporary storage location.");
 
+          prm.declare_entry ("Compress columnar output", "false",
+                             Patterns::Bool(),
+                             "Whether to compress the data written in the `columnar' output "
+                             "format. Compression reduces the file size, in particular for "
+                             "properties that vary little between particles, at the cost of "
+                             "additional computing time. Each column written by each process "
+                             "is compressed separately with zlib.");
+
+          prm.declare_entry ("Fraction of particles in output", "1.",
+                             Patterns::Double(0., 1.),
+                             "The fraction of all particles that is written to output files. "
+                             "If this value is smaller than one, a random subset of the "
+                             "particles of this size is written in all output formats. The "
+                             "selection of a particle only depends on its id, so the same "
+                             "particles are written every time, and their paths can be "
+                             "followed over time.");
+
           prm.declare_entry ("Exclude output properties", "",
                              Patterns::Anything(),
                              "A comma separated list of particle properties that should "
@@ -720,6 +1012,9 @@ namespace aspect
                                      "after writing. The system() command did not succeed in finding such a terminal."));
             }
 
+          compress_columnar_output = prm.get_bool("Compress columnar output");
+          output_fraction = prm.get_double("Fraction of particles in output");
+
           exclude_output_properties = Utilities::split_string_list(prm.get("Exclude output properties"));
 
           // Never output the integrator properties that are for internal use only
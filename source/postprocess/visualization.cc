@@ -27,7 +27,9 @@
 #include <aspect/mesh_deformation/interface.h>
 #include <deal.II/fe/mapping_q1_eulerian.h>
 
+#include <deal.II/base/timer.h>
 #include <deal.II/dofs/dof_tools.h>
+#include <deal.II/grid/filtered_iterator.h>
 #include <deal.II/numerics/data_out.h>
 #include <deal.II/numerics/data_out_faces.h>
 
@@ -39,6 +41,8 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <iomanip>
+#include <limits>
 #include <type_traits>
 
 #include <boost/lexical_cast.hpp>
@@ -288,6 +292,53 @@ namespace aspect
     }
 
 
+
+    namespace internal
+    {
+      /**
+       * A class that collects the graphical output patches created by
+       * several processes, after they have been sent to the current process
+       * in deal.II's intermediate format. The collected patches can then be
+       * written by the current process as if it had created them itself.
+       */
+      template <int patch_dim, int spacedim>
+      class PatchAggregator : public DataOutReader<patch_dim,spacedim>
+      {
+        public:
+          /**
+           * Add the patches described by @p intermediate_data, which has
+           * been created by DataOutInterface::write_deal_II_intermediate(),
+           * to the patches already stored in this object.
+           */
+          void add_patches (const std::string &intermediate_data);
+      };
+
+
+
+      template <int patch_dim, int spacedim>
+      void
+      PatchAggregator<patch_dim,spacedim>::add_patches (const std::string &intermediate_data)
+      {
+        std::istringstream in (intermediate_data);
+
+        // DataOutReader::merge() requires both sides to have patches, so
+        // as long as we do not have any patches ourselves simply replace
+        // our (empty) content by the new data. This also makes sure that we
+        // know the names of all data sets even if none of the processes
+        // on this node has any patches.
+        if (this->get_patches().size() == 0)
+          this->read (in);
+        else
+          {
+            PatchAggregator<patch_dim,spacedim> other;
+            other.read (in);
+            if (other.get_patches().size() > 0)
+              this->merge (other);
+          }
+      }
+    }
+
+
     template <int dim>
     Visualization<dim>::OutputHistory::OutputHistory()
       :
@@ -483,13 +534,9 @@ namespace aspect
 
       if (output_format == "hdf5")
         {
-          XDMFEntry new_xdmf_entry;
           const std::string h5_solution_file_name = "solution/"
                                                     + solution_file_prefix + ".h5";
           const std::string xdmf_filename = "solution.xdmf";
-          // Filter redundant values if requested in the input file
-          DataOutBase::DataOutFilter data_filter(
-            DataOutBase::DataOutFilterFlags(filter_output, true));
           // If the mesh changed since the last output, make a new mesh file
           const std::string mesh_file_prefix =
             (is_cell_data_output ? "mesh-" : "mesh_surface-")
@@ -497,20 +544,91 @@ namespace aspect
           if (output_history.mesh_changed)
             output_history.last_mesh_file_name = "solution/" + mesh_file_prefix + ".h5";
 
-          data_out.write_filtered_data(data_filter);
-          data_out.write_hdf5_parallel(data_filter,
-                                       output_history.mesh_changed,
-                                       this->get_output_directory() + output_history.last_mesh_file_name,
-                                       this->get_output_directory() + h5_solution_file_name,
-                                       this->get_mpi_communicator());
-          new_xdmf_entry = data_out.create_xdmf_entry(data_filter,
-                                                      output_history.last_mesh_file_name,
-                                                      h5_solution_file_name,
-                                                      time_in_years_or_seconds, this->get_mpi_communicator());
-          output_history.xdmf_entries.push_back(new_xdmf_entry);
-          data_out.write_xdmf_file(output_history.xdmf_entries,
-                                   this->get_output_directory() + xdmf_filename,
-                                   this->get_mpi_communicator());
+          // Write the patches stored in 'output_writer' into the .h5 files,
+          // collectively for all processes in 'comm', and update the
+          // .xdmf file that references all of the .h5 files written so far.
+          const auto write_hdf5_files = [&](const auto &output_writer,
+                                            const MPI_Comm comm)
+          {
+            // Filter redundant values if requested in the input file
+            DataOutBase::DataOutFilter data_filter(
+              DataOutBase::DataOutFilterFlags(filter_output, true));
+
+            output_writer.write_filtered_data(data_filter);
+            output_writer.write_hdf5_parallel(data_filter,
+                                              output_history.mesh_changed,
+                                              this->get_output_directory() + output_history.last_mesh_file_name,
+                                              this->get_output_directory() + h5_solution_file_name,
+                                              comm);
+            const XDMFEntry new_xdmf_entry = output_writer.create_xdmf_entry(data_filter,
+                                                                             output_history.last_mesh_file_name,
+                                                                             h5_solution_file_name,
+                                                                             time_in_years_or_seconds, comm);
+            output_history.xdmf_entries.push_back(new_xdmf_entry);
+            output_writer.write_xdmf_file(output_history.xdmf_entries,
+                                          this->get_output_directory() + xdmf_filename,
+                                          comm);
+          };
+
+          if (aggregate_hdf5_output_per_node == false)
+            write_hdf5_files (data_out, this->get_mpi_communicator());
+          else
+            {
+              // Funnel the patches of all processes that share memory on one
+              // node to the first process of this node (the 'aggregator'), and
+              // only let the aggregators participate in the collective
+              // write operation. This reduces the number of processes that
+              // access the parallel file system from the number of
+              // processes to the number of nodes, and every one of them
+              // writes a large contiguous block of data.
+              const int my_id = Utilities::MPI::this_mpi_process(this->get_mpi_communicator());
+
+              MPI_Comm node_comm;
+              int ierr = MPI_Comm_split_type(this->get_mpi_communicator(), MPI_COMM_TYPE_SHARED,
+                                             my_id, MPI_INFO_NULL, &node_comm);
+              AssertThrowMPI(ierr);
+
+              const bool is_aggregator = (Utilities::MPI::this_mpi_process(node_comm) == 0);
+
+              // Because we use the rank as key, process 0 is always an
+              // aggregator and also process 0 of the aggregator communicator.
+              // Consequently, it is the one that writes the .xdmf file
+              // and stores the XDMF entries, just as without aggregation.
+              MPI_Comm aggregator_comm;
+              ierr = MPI_Comm_split(this->get_mpi_communicator(),
+                                    (is_aggregator ? 0 : MPI_UNDEFINED),
+                                    my_id, &aggregator_comm);
+              AssertThrowMPI(ierr);
+
+              std::ostringstream local_patches;
+              local_patches << std::setprecision(std::numeric_limits<double>::max_digits10);
+              data_out.write_deal_II_intermediate(local_patches);
+
+              const std::vector<std::string> node_patches
+                = Utilities::MPI::gather(node_comm, local_patches.str(), 0);
+
+              if (is_aggregator)
+                {
+                  constexpr int patch_dim = (std::is_same<DataOutType,DataOut<dim>>::value ? dim : dim-1);
+                  internal::PatchAggregator<patch_dim,dim> aggregated_output;
+                  for (const auto &patches : node_patches)
+                    aggregated_output.add_patches (patches);
+
+                  write_hdf5_files (aggregated_output, aggregator_comm);
+
+                  ierr = MPI_Comm_free(&aggregator_comm);
+                  AssertThrowMPI(ierr);
+                }
+              else
+                // Like all processes other than process 0 in the non-aggregated
+                // case, store an empty entry to keep the output history of
+                // all processes the same length
+                output_history.xdmf_entries.emplace_back();
+
+              ierr = MPI_Comm_free(&node_comm);
+              AssertThrowMPI(ierr);
+            }
+
           output_history.mesh_changed = false;
         }
       else if (output_format == "vtu")
@@ -725,6 +843,22 @@ namespace aspect
                                              std::vector<std::string> (output_data_names.size(), output_units),
                                              output_data_names_and_units);
       }
+
+
+
+      /**
+       * Return the size of the given file in bytes, or zero if the file
+       * can not be opened.
+       */
+      double
+      file_size_in_bytes (const std::string &filename)
+      {
+        std::ifstream file (filename, std::ios::binary | std::ios::ate);
+        if (!file)
+          return 0.;
+
+        return static_cast<double>(file.tellg());
+      }
     }
 
 
@@ -953,6 +1087,22 @@ namespace aspect
 
         }
 
+      // If requested, restrict the output to those cells that intersect
+      // the region of interest. This only affects the cell based output;
+      // surface output is typically small enough to always be written for
+      // the whole surface.
+      if (output_region != entire_domain)
+        data_out.set_cell_selection(
+          FilteredIterator<typename Triangulation<dim>::cell_iterator>(
+            [&](const typename Triangulation<dim>::cell_iterator &cell)
+        {
+          // DataOut iterates over all cells of the triangulation, not
+          // only the active ones, so we have to filter these out first
+          return cell->is_active()
+                 && cell->is_locally_owned()
+                 && cell_is_in_output_region(cell);
+        }));
+
       // Now build the patches. If selected, increase the output resolution.
       // Giving the mapping ensures that the case with mesh deformation works correctly.
       const unsigned int subdivisions = interpolate_output
@@ -981,13 +1131,47 @@ namespace aspect
                                 :
                                 DataOut<dim>::no_curved_cells);
 
+        // Remember whether a new mesh file is going to be written before
+        // writing the data resets this flag
+        const bool write_mesh_file = cell_output_history.mesh_changed;
+
+        Timer write_timer;
         solution_file_prefix
           = write_data_out_data(data_out, cell_output_history,
                                 visualization_field_names_and_units);
+        write_timer.stop();
+
         statistics.add_value ("Visualization file name",
                               this->get_output_directory()
                               + "solution/"
                               + solution_file_prefix);
+
+        // For HDF5 output all processes have finished writing the data
+        // to disk once the function above returns, so we can compute the
+        // bandwidth we achieved from the size of the files written and the
+        // time spent in the slowest process. The bandwidth depends on the
+        // machine, so we only report it if the user asked for aggregation,
+        // which is what it helps to tune.
+        if (output_format == "hdf5" && aggregate_hdf5_output_per_node)
+          {
+            double bytes_written = 0;
+            if (Utilities::MPI::this_mpi_process(this->get_mpi_communicator()) == 0)
+              {
+                bytes_written += file_size_in_bytes (this->get_output_directory() + "solution/"
+                                                     + solution_file_prefix + ".h5");
+                if (write_mesh_file)
+                  bytes_written += file_size_in_bytes (this->get_output_directory()
+                                                       + cell_output_history.last_mesh_file_name);
+              }
+            bytes_written = Utilities::MPI::max (bytes_written, this->get_mpi_communicator());
+            const double write_time = Utilities::MPI::max (write_timer.wall_time(), this->get_mpi_communicator());
+
+            const std::string column = "Visualization write bandwidth (MB/s)";
+            statistics.add_value (column,
+                                  (write_time > 0 ? bytes_written / write_time / 1e6 : 0.));
+            statistics.set_precision (column, 4);
+            statistics.set_scientific (column, true);
+          }
       }
 
       // Then do the same again for the face data case. We won't print the
@@ -1022,6 +1206,54 @@ namespace aspect
     }
 
 
+    template <int dim>
+    bool
+    Visualization<dim>::cell_is_in_output_region (const typename Triangulation<dim>::cell_iterator &cell) const
+    {
+      switch (output_region)
+        {
+          case entire_domain:
+            return true;
+
+          case box:
+          {
+            // The cell intersects the box if their extents overlap
+            // in every coordinate direction
+            const std::pair<Point<dim>,Point<dim>> cell_extent = cell->bounding_box().get_boundary_points();
+            for (unsigned int d=0; d<dim; ++d)
+              if ((cell_extent.first[d] > output_region_maximum_point[d])
+                  ||
+                  (cell_extent.second[d] < output_region_minimum_point[d]))
+                return false;
+            return true;
+          }
+
+          case depth_range:
+          {
+            // Use the range of depths of the vertices of the cell to
+            // decide whether the cell intersects the depth range
+            double min_cell_depth = std::numeric_limits<double>::max();
+            double max_cell_depth = std::numeric_limits<double>::lowest();
+            for (const unsigned int v : cell->vertex_indices())
+              {
+                const double depth = this->get_geometry_model().depth(cell->vertex(v));
+                min_cell_depth = std::min(min_cell_depth, depth);
+                max_cell_depth = std::max(max_cell_depth, depth);
+              }
+            return (min_cell_depth <= output_region_maximum_depth)
+                   &&
+                   (max_cell_depth >= output_region_minimum_depth);
+          }
+
+          default:
+            Assert (false, ExcNotImplemented());
+        }
+
+      return true;
+    }
+
+
+
     template <int dim>
     void Visualization<dim>::writer (const std::string &filename,
                                      const std::string &temporary_output_location,
@@ -1139,6 +1371,21 @@ namespace aspect
                              "solution, while a larger value will create that many files "
                              "(at most as many as there are MPI ranks).");
 
+          prm.declare_entry ("Aggregate HDF5 output per node", "false",
+                             Patterns::Bool(),
+                             "When writing HDF5 output on many processes, the collective "
+                             "write operation in which every process writes its own part of "
+                             "the solution into a single file can overwhelm the parallel "
+                             "file system. If this parameter is set to `true', all processes "
+                             "that share memory on one node first send their output data "
+                             "to one process of that node, and only these processes then "
+                             "write the data collectively into the same files as without "
+                             "aggregation. This reduces the number of processes that access "
+                             "the file system to the number of nodes, at the cost of "
+                             "additional memory on the aggregating processes. The achieved "
+                             "write bandwidth is then reported in the statistics file. This option "
+                             "is only available for the `hdf5' output format.");
+
           prm.declare_entry ("Write in background thread", "false",
                              Patterns::Bool(),
                              "File operations can potentially take a long time, blocking the "
@@ -1193,6 +1440,51 @@ namespace aspect
                              "and a factor of 8 in 3d, when using quadratic elements for the velocity, "
                              "and correspondingly more for even higher order elements.");
 
+          prm.declare_entry ("Output region", "entire domain",
+                             Patterns::Selection ("entire domain|box|depth range"),
+                             "The part of the domain for which graphical output is written. "
+                             "By default, every cell of the mesh is written. If `box' is "
+                             "selected, only those cells that intersect the box described "
+                             "by the parameters `Output region minimum point' and `Output "
+                             "region maximum point' are written. If `depth range' is "
+                             "selected, only those cells that intersect the depth interval "
+                             "between `Output region minimum depth' and `Output region "
+                             "maximum depth' are written. Restricting the output to a "
+                             "region of interest can reduce the size of output files and "
+                             "the time spent writing them by orders of magnitude, which "
+                             "is useful for frequent monitoring output of large models. "
+                             "This parameter only affects cell based output, not the "
+                             "output of visualization postprocessors that only produce "
+                             "output on the surface of the domain.");
+
+          prm.declare_entry ("Output region minimum point", "",
+                             Patterns::List (Patterns::Double(), 0, dim),
+                             "The lower corner of the box for which graphical output is "
+                             "written if `Output region' is set to `box'. The box is given "
+                             "as a comma separated list of one coordinate per spatial "
+                             "dimension, in Cartesian coordinates. "
+                             "Units: \\si{\\meter}.");
+
+          prm.declare_entry ("Output region maximum point", "",
+                             Patterns::List (Patterns::Double(), 0, dim),
+                             "The upper corner of the box for which graphical output is "
+                             "written if `Output region' is set to `box'. The box is given "
+                             "as a comma separated list of one coordinate per spatial "
+                             "dimension, in Cartesian coordinates. "
+                             "Units: \\si{\\meter}.");
+
+          prm.declare_entry ("Output region minimum depth", "0.",
+                             Patterns::Double (0.),
+                             "The smallest depth for which graphical output is written if "
+                             "`Output region' is set to `depth range'. "
+                             "Units: \\si{\\meter}.");
+
+          prm.declare_entry ("Output region maximum depth", boost::lexical_cast<std::string>(std::numeric_limits<double>::max()),
+                             Patterns::Double (0.),
+                             "The largest depth for which graphical output is written if "
+                             "`Output region' is set to `depth range'. "
+                             "Units: \\si{\\meter}.");
+
           prm.declare_entry ("Point-wise stress and strain", "false",
                              Patterns::Bool(),
                              "If set to true, quantities related to stress and strain are computed "
@@ -1337,6 +1629,11 @@ namespace aspect
 
           output_format   = prm.get ("Output format");
           group_files     = prm.get_integer("Number of grouped files");
+          aggregate_hdf5_output_per_node = prm.get_bool("Aggregate HDF5 output per node");
+          AssertThrow(aggregate_hdf5_output_per_node == false || output_format == "hdf5",
+                      ExcMessage("The option 'Postprocess/Visualization/Aggregate HDF5 output per node' "
+                                 "requires the data output format to be set to 'hdf5'."));
+
           write_in_background_thread = prm.get_bool("Write in background thread");
           temporary_output_location = prm.get("Temporary output location");
 
@@ -1353,6 +1650,43 @@ namespace aspect
             }
 
           interpolate_output = prm.get_bool("Interpolate output");
+
+          if (prm.get("Output region") == "entire domain")
+            output_region = entire_domain;
+          else if (prm.get("Output region") == "box")
+            {
+              output_region = box;
+
+              const std::vector<double> minimum_point
+                = Utilities::string_to_double(Utilities::split_string_list(prm.get("Output region minimum point")));
+              const std::vector<double> maximum_point
+                = Utilities::string_to_double(Utilities::split_string_list(prm.get("Output region maximum point")));
+              AssertThrow(minimum_point.size() == dim && maximum_point.size() == dim,
+                          ExcMessage("The parameters 'Output region minimum point' and 'Output region "
+                                     "maximum point' need to contain exactly one coordinate per spatial "
+                                     "dimension if 'Output region' is set to 'box'."));
+
+              for (unsigned int d=0; d<dim; ++d)
+                {
+                  AssertThrow(minimum_point[d] <= maximum_point[d],
+                              ExcMessage("The coordinates of 'Output region minimum point' need to be "
+                                         "smaller than the ones of 'Output region maximum point'."));
+                  output_region_minimum_point[d] = minimum_point[d];
+                  output_region_maximum_point[d] = maximum_point[d];
+                }
+            }
+          else if (prm.get("Output region") == "depth range")
+            {
+              output_region = depth_range;
+              output_region_minimum_depth = prm.get_double("Output region minimum depth");
+              output_region_maximum_depth = prm.get_double("Output region maximum depth");
+              AssertThrow(output_region_minimum_depth <= output_region_maximum_depth,
+                          ExcMessage("The parameter 'Output region minimum depth' needs to be "
+                                     "smaller than 'Output region maximum depth'."));
+            }
+          else
+            AssertThrow(false, ExcNotImplemented());
+
           filter_output = prm.get_bool("Filter output");
           pointwise_stress_and_strain = prm.get_bool("Point-wise stress and strain");
           write_higher_order_output = prm.get_bool("Write higher order output");
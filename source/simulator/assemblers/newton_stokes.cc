@@ -75,9 +75,10 @@ namespace aspect
             {
               if (introspection.is_stokes_component(fe.system_to_component_index(i).first))
                 {
-                  scratch.grads_phi_u[i_stokes] =
-                    scratch.finite_element_values[introspection.extractors
-                                                  .velocities].symmetric_gradient(i, q);
+                  if (this->get_parameters().use_full_A_block_preconditioner == false)
+                    scratch.grads_phi_u[i_stokes] =
+                      scratch.finite_element_values[introspection.extractors
+                                                    .velocities].symmetric_gradient(i, q);
                   scratch.phi_p[i_stokes] = scratch.finite_element_values[introspection
                                                                           .extractors.pressure].value(i, q);
 
@@ -95,6 +96,24 @@ namespace aspect
           const double one_over_eta = 1. / eta;
           const double JxW = scratch.finite_element_values.JxW(q);
 
+          // if the AMG preconditioner is built from the full A block of the
+          // system matrix, the top left block of the preconditioner matrix
+          // is not used, and no memory is allocated for it. so only
+          // assemble the pressure mass matrix in that case
+          if (this->get_parameters().use_full_A_block_preconditioner)
+            {
+              for (unsigned int i = 0; i < stokes_dofs_per_cell; ++i)
+                for (unsigned int j = 0; j < stokes_dofs_per_cell; ++j)
+                  if (scratch.dof_component_indices[i] ==
+                      scratch.dof_component_indices[j])
+                    data.local_matrix(i, j) += one_over_eta
+                                               * pressure_scaling
+                                               * pressure_scaling
+                                               * (scratch.phi_p[i] * scratch.phi_p[j])
+                                               * JxW;
+              continue;
+            }
+
           // TODO: Find out why in this version of ASPECT adding the derivative to the preconditioning
           // is way worse than the normal preconditioning
           if (derivative_scaling_factor == 0)
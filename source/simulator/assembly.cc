@@ -424,12 +424,103 @@ namespace aspect
     else
       AssertThrow(false, ExcNotImplemented());
 
+    if (parameters.stokes_preconditioner_rebuild_policy == Parameters<dim>::StokesPreconditionerRebuildPolicy::adaptive)
+      {
+        StokesPreconditionerMonitor &monitor = stokes_preconditioner_monitor;
+
+        // decide whether the preconditioner we already have is still good
+        // enough: it must exist and there must have been a solve with it
+        // since it was built, the last solve must not have needed many more
+        // iterations than the first one after the rebuild, and the viscosity
+        // must not have changed much anywhere
+        bool reuse = (Amg_preconditioner != nullptr
+                      && Mp_preconditioner != nullptr
+                      && monitor.force_rebuild == false
+                      && monitor.n_iterations_after_last_rebuild != numbers::invalid_unsigned_int
+                      && monitor.n_reuses_since_last_rebuild < parameters.stokes_preconditioner_max_reuses
+                      && monitor.n_iterations <= parameters.stokes_preconditioner_iteration_growth
+                      * std::max (monitor.n_iterations_after_last_rebuild, 1U));
+
+        double max_viscosity_change = 0;
+        if (reuse)
+          {
+            for (const auto &cell : dof_handler.active_cell_iterators())
+              if (cell->is_locally_owned())
+                max_viscosity_change = std::max<double> (max_viscosity_change,
+                                                         std::abs(monitor.log_viscosity(cell->active_cell_index())
+                                                                  - monitor.log_viscosity_at_last_rebuild(cell->active_cell_index())));
+            max_viscosity_change = Utilities::MPI::max (max_viscosity_change, mpi_communicator);
+
+            reuse = (max_viscosity_change <= parameters.stokes_preconditioner_viscosity_change);
+          }
+
+        if (reuse)
+          {
+            pcout << "   Reusing Stokes preconditioner (" << monitor.n_iterations
+                  << " iterations in the last solve, viscosity changed by up to "
+                  << max_viscosity_change << " orders of magnitude)." << std::endl;
+
+            ++monitor.n_reuses_since_last_rebuild;
+            ++monitor.n_reuses;
+            rebuild_stokes_preconditioner = false;
+            return;
+          }
+
+        monitor.log_viscosity_at_last_rebuild = monitor.log_viscosity;
+        monitor.n_iterations_after_last_rebuild = numbers::invalid_unsigned_int;
+        monitor.n_reuses_since_last_rebuild = 0;
+        monitor.force_rebuild = false;
+        ++monitor.n_rebuilds;
+      }
+
     TimerOutput::Scope timer (computing_timer, "Build Stokes preconditioner");
-    pcout << "   Rebuilding Stokes preconditioner..." << std::flush;
+
+    // the preconditioners are deleted in setup_system_matrices()
+    // whenever the matrices are recreated (i.e., in particular after
+    // setup_dofs()), so if they still exist, they were built for a matrix
+    // with the same sparsity pattern as the current one
+    const bool reuse_amg_aggregation = (parameters.AMG_reuse_aggregation
+                                        && Amg_preconditioner != nullptr
+                                        && Mp_preconditioner != nullptr);
+
+    if (reuse_amg_aggregation)
+      pcout << "   Rebuilding Stokes preconditioner (reusing AMG aggregation)..." << std::flush;
+    else
+      pcout << "   Rebuilding Stokes preconditioner..." << std::flush;
 
     // first assemble the raw matrices necessary for the preconditioner
     assemble_stokes_preconditioner ();
 
+    // if possible, keep the aggregates and transfer operators of the existing
+    // AMG hierarchies and only recompute the coarse level matrices and the
+    // smoothers from the new matrix entries. this skips the most expensive
+    // part of the AMG setup. the ILU of the pressure mass matrix has no such
+    // structure to reuse and is simply recomputed.
+    if (reuse_amg_aggregation)
+      {
+        Amg_preconditioner->reinit ();
+
+        if (parameters.include_melt_transport == false)
+          {
+            LinearAlgebra::PreconditionILU *Mp_preconditioner_ILU
+              = dynamic_cast<LinearAlgebra::PreconditionILU *> (Mp_preconditioner.get());
+            Assert (Mp_preconditioner_ILU != nullptr, ExcInternalError());
+            Mp_preconditioner_ILU->initialize (system_preconditioner_matrix.block(1,1));
+          }
+        else
+          {
+            LinearAlgebra::PreconditionAMG *Mp_preconditioner_AMG
+              = dynamic_cast<LinearAlgebra::PreconditionAMG *> (Mp_preconditioner.get());
+            Assert (Mp_preconditioner_AMG != nullptr, ExcInternalError());
+            Mp_preconditioner_AMG->reinit ();
+          }
+
+        rebuild_stokes_preconditioner = false;
+
+        pcout << std::endl;
+        return;
+      }
+
     // then extract the other information necessary to build the
     // AMG preconditioners for the A and M blocks
     std::vector<std::vector<bool>> constant_modes;
@@ -574,6 +665,22 @@ namespace aspect
                                                scratch.finite_element_values.get_mapping(),
                                                scratch.material_model_outputs);
 
+    // record the cell-averaged viscosity for the adaptive rebuild policy
+    // of the Stokes preconditioner. different cells write to different
+    // entries of the vector, so this is safe to do from several threads
+    if (need_viscosity
+        &&
+        parameters.stokes_preconditioner_rebuild_policy == Parameters<dim>::StokesPreconditionerRebuildPolicy::adaptive
+        &&
+        parameters.stokes_solver_type == Parameters<dim>::StokesSolverType::block_amg)
+      {
+        double log_viscosity = 0;
+        for (const double viscosity : scratch.material_model_outputs.viscosities)
+          log_viscosity += std::log10(viscosity);
+        stokes_preconditioner_monitor.log_viscosity(cell->active_cell_index())
+          = log_viscosity / scratch.material_model_outputs.viscosities.size();
+      }
+
     scratch.finite_element_values[introspection.extractors.velocities].get_function_values(current_linearization_point,
         scratch.velocity_values);
     if (assemble_newton_stokes_system)
@@ -33,6 +33,8 @@
 #  include <zlib.h>
 #endif
 
+#include <cstring>
+
 namespace aspect
 {
   namespace
@@ -67,6 +69,202 @@ namespace aspect
                                               + Utilities::to_string(error) + "."));
         }
     }
+
+
+
+    /**
+     * The file restart.resume.z starts with this identifier, followed by
+     * the version of the layout of the file as an unsigned 32 bit integer.
+     * Files written before the identifier was introduced consist of a
+     * single compressed section and correspond to version 1. Increase the
+     * version whenever the layout or the content of the file changes in a
+     * way that older files can no longer be read.
+     */
+    const std::string resume_file_identifier = "ASPECT resume file";
+    const uint32_t resume_file_version = 2;
+
+
+
+    /**
+     * Compress @p data with zlib and return it prefixed by the compression
+     * header that describes the size of the compressed and uncompressed
+     * data. A restart file consists of one or more such sections.
+     */
+    std::string compress_section (const std::string &data)
+    {
+#ifdef DEAL_II_WITH_ZLIB
+      uLongf compressed_data_length = compressBound (data.length());
+      std::vector<char> compressed_data (compressed_data_length);
+      int err = compress2 (reinterpret_cast<Bytef *>(&compressed_data[0]),
+                           &compressed_data_length,
+                           reinterpret_cast<const Bytef *>(data.data()),
+                           data.length(),
+                           Z_BEST_COMPRESSION);
+      (void)err;
+      Assert (err == Z_OK, ExcInternalError());
+
+      // build compression header
+      const uint32_t compression_header[4]
+        = { 1,                                   /* number of blocks */
+            static_cast<uint32_t>(data.length()), /* size of block */
+            static_cast<uint32_t>(data.length()), /* size of last block */
+            static_cast<uint32_t>(compressed_data_length)
+          }; /* list of compressed sizes of blocks */
+
+      std::string section (reinterpret_cast<const char *>(compression_header),
+                           4 * sizeof(compression_header[0]));
+      section.append (&compressed_data[0], compressed_data_length);
+      return section;
+#else
+      (void)data;
+      AssertThrow (false,
+                   ExcMessage ("You need to have deal.II configured with the `libz' "
+                               "option to support checkpoint/restart, but deal.II "
+                               "did not detect its presence when you called `cmake'."));
+      return "";
+#endif
+    }
+
+
+
+    /**
+     * Return the length in bytes (including the compression header) of the
+     * compressed section that starts at the beginning of @p data, or zero
+     * if @p data does not start with a complete section.
+     */
+    std::size_t length_of_first_section (const std::string &data)
+    {
+      uint32_t compression_header[4];
+      if (data.size() < sizeof(compression_header))
+        return 0;
+
+      std::memcpy (compression_header, data.data(), sizeof(compression_header));
+      const std::size_t length = sizeof(compression_header) + compression_header[3];
+
+      return (length <= data.size() ? length : 0);
+    }
+
+
+
+    /**
+     * The inverse of compress_section(): Take a section consisting of the
+     * compression header and the compressed data, and return the
+     * uncompressed data.
+     */
+    std::string uncompress_section (const std::string &section)
+    {
+#ifdef DEAL_II_WITH_ZLIB
+      AssertThrow (length_of_first_section(section) == section.size(),
+                   ExcMessage ("The restart file appears to be truncated or corrupted."));
+
+      uint32_t compression_header[4];
+      std::memcpy (compression_header, section.data(), sizeof(compression_header));
+      Assert(compression_header[0]==1, ExcInternalError());
+
+      std::vector<char> uncompressed(compression_header[1]);
+      uLongf uncompressed_size = compression_header[1];
+
+      const int err = uncompress(reinterpret_cast<Bytef *>(&uncompressed[0]), &uncompressed_size,
+                                 reinterpret_cast<const Bytef *>(section.data() + sizeof(compression_header)),
+                                 compression_header[3]);
+      AssertThrow (err == Z_OK,
+                   ExcMessage (std::string("Uncompressing the data buffer resulted in an error with code <")
+                               +
+                               Utilities::int_to_string(err)));
+
+      return std::string (&uncompressed[0], uncompressed_size);
+#else
+      (void)section;
+      AssertThrow (false,
+                   ExcMessage ("You need to have deal.II configured with the `libz' "
+                               "option to support checkpoint/restart, but deal.II "
+                               "did not detect its presence when you called `cmake'."));
+      return "";
+#endif
+    }
+
+
+
+    /**
+     * Compress each of the serialized parts of the state of the simulation
+     * given in @p sections separately and write them one after the other
+     * into the file @p filename. Keeping the parts separate allows reading
+     * back only the ones a process needs.
+     */
+    void write_compressed_resume_file (const std::vector<std::string> &sections,
+                                       const std::string &filename)
+    {
+      std::ofstream f (filename, std::ios::binary);
+      f.write(resume_file_identifier.data(), resume_file_identifier.size());
+      f.write(reinterpret_cast<const char *>(&resume_file_version), sizeof(resume_file_version));
+      std::size_t file_size = resume_file_identifier.size() + sizeof(resume_file_version);
+      for (const auto &data : sections)
+        {
+          const std::string section = compress_section (data);
+          f.write(section.data(), section.size());
+          file_size += section.size();
+        }
+      f.close();
+
+      // We check the fail state of the stream _after_ closing the file to
+      // make sure the writes were completed correctly. This also catches
+      // the cases where the file could not be opened in the first place
+      // or one of the write() commands fails, as the fail state is
+      // "sticky".
+      if (!f)
+        AssertThrow(false, ExcMessage ("Writing of the checkpoint file '" + filename
+                                       + "' with size "
+                                       + Utilities::to_string(file_size)
+                                       + " failed on processor 0."));
+    }
+
+
+
+    /**
+     * Rename the files of a newly written snapshot in @p output_directory
+     * so that they replace the files of the previous snapshot. If
+     * @p previous_snapshot_exists is true, the files of the previous
+     * snapshot are kept with the suffix '.old'.
+     */
+    void move_snapshot_into_place (const std::string &output_directory,
+                                   const bool previous_snapshot_exists)
+    {
+      if (previous_snapshot_exists == true)
+        {
+          move_file (output_directory + "restart.mesh",
+                     output_directory + "restart.mesh.old");
+          move_file (output_directory + "restart.mesh.info",
+                     output_directory + "restart.mesh.info.old");
+          move_file (output_directory + "restart.resume.z",
+                     output_directory + "restart.resume.z.old");
+
+          move_file (output_directory + "restart.mesh_fixed.data",
+                     output_directory + "restart.mesh_fixed.data.old");
+
+          if (Utilities::fexists(output_directory + "restart.mesh_variable.data"))
+            {
+              move_file (output_directory + "restart.mesh_variable.data",
+                         output_directory + "restart.mesh_variable.data.old");
+            }
+
+        }
+
+      move_file (output_directory + "restart.mesh.new",
+                 output_directory + "restart.mesh");
+      move_file (output_directory + "restart.mesh.new.info",
+                 output_directory + "restart.mesh.info");
+      move_file (output_directory + "restart.resume.z.new",
+                 output_directory + "restart.resume.z");
+
+      move_file (output_directory + "restart.mesh.new_fixed.data",
+                 output_directory + "restart.mesh_fixed.data");
+
+      if (Utilities::fexists(output_directory + "restart.mesh.new_variable.data"))
+        {
+          move_file (output_directory + "restart.mesh.new_variable.data",
+                     output_directory + "restart.mesh_variable.data");
+        }
+    }
   }
 
 
@@ -275,6 +473,17 @@ namespace aspect
 
     const unsigned int my_id = Utilities::MPI::this_mpi_process (mpi_communicator);
 
+    // If the previous snapshot is still being written in the background,
+    // wait for it to be finished before we start overwriting its files.
+    // Only process 0 writes in the background, so all other processes
+    // have to wait for it as well.
+    wait_for_checkpoint_writer_thread();
+    if (parameters.write_checkpoint_in_background_thread)
+      {
+        const int ierr = MPI_Barrier(mpi_communicator);
+        AssertThrowMPI(ierr);
+      }
+
     // save Triangulation and Solution vectors:
     {
       std::vector<const LinearAlgebra::BlockVector *> x_system
@@ -313,71 +522,37 @@ namespace aspect
 
     // save general information This calls the serialization functions on all
     // processes (so that they can take additional action, if necessary, see
-    // the manual) but only writes to the restart file on process 0
+    // the manual) but only writes to the restart file on process 0. We
+    // serialize into a stringstream that serves as staging buffer, so that
+    // compressing and writing it can happen later, and possibly in the
+    // background.
+    //
+    // The statistics table is only ever needed on process 0 and can become
+    // large for long model runs. It is therefore stored in a separate
+    // section of the file that only process 0 reads upon restart.
+    std::ostringstream oss;
     {
-      std::ostringstream oss;
-
-      // serialize into a stringstream
       aspect::oarchive oa (oss);
       save_critical_parameters (this->parameters, oa);
       oa << (*this);
-
-      // compress with zlib and write to file on the root processor
-#ifdef DEAL_II_WITH_ZLIB
-      if (my_id == 0)
-        {
-          uLongf compressed_data_length = compressBound (oss.str().length());
-          std::vector<char *> compressed_data (compressed_data_length);
-          int err = compress2 (reinterpret_cast<Bytef *>(&compressed_data[0]),
-                               &compressed_data_length,
-                               reinterpret_cast<const Bytef *>(oss.str().data()),
-                               oss.str().length(),
-                               Z_BEST_COMPRESSION);
-          (void)err;
-          Assert (err == Z_OK, ExcInternalError());
-
-          // build compression header
-          const uint32_t compression_header[4]
-            = { 1,                                   /* number of blocks */
-                static_cast<uint32_t>(oss.str().length()), /* size of block */
-                static_cast<uint32_t>(oss.str().length()), /* size of last block */
-                static_cast<uint32_t>(compressed_data_length)
-              }; /* list of compressed sizes of blocks */
-
-          std::ofstream f ((parameters.output_directory + "restart.resume.z.new"));
-          f.write(reinterpret_cast<const char *>(compression_header), 4 * sizeof(compression_header[0]));
-          f.write(reinterpret_cast<char *>(&compressed_data[0]), compressed_data_length);
-          f.close();
-
-          // We check the fail state of the stream _after_ closing the file to
-          // make sure the writes were completed correctly. This also catches
-          // the cases where the file could not be opened in the first place
-          // or one of the write() commands fails, as the fail state is
-          // "sticky".
-          if (!f)
-            AssertThrow(false, ExcMessage ("Writing of the checkpoint file '" + parameters.output_directory
-                                           + "restart.resume.z.new' with size "
-                                           + Utilities::to_string(4 * sizeof(compression_header[0])+compressed_data_length)
-                                           + " failed on processor 0."));
-        }
-#else
-      AssertThrow (false,
-                   ExcMessage ("You need to have deal.II configured with the `libz' "
-                               "option to support checkpoint/restart, but deal.II "
-                               "did not detect its presence when you called `cmake'."));
-#endif
-
     }
 
+    std::ostringstream statistics_oss;
+    if (my_id == 0)
+      {
+        aspect::oarchive oa (statistics_oss);
+        oa << statistics;
+      }
+
     // Wait for everyone to finish writing
     const int ierr = MPI_Barrier(mpi_communicator);
     AssertThrowMPI(ierr);
 
-    // Now rename the snapshots to put the new one in place of the old one.
-    // Do this after writing the new one, because writing large checkpoints
-    // can be slow, and the model might be cancelled during writing.
-    // This way restart remains usable even if restart.new is not completely
-    // written.
+    // Now write the general information and then rename the snapshots to
+    // put the new one in place of the old one. Do this after writing the
+    // new one, because writing large checkpoints can be slow, and the model
+    // might be cancelled during writing. This way restart remains usable
+    // even if restart.new is not completely written.
     if (my_id == 0)
       {
         // if we have previously written a snapshot, then keep the last
@@ -385,42 +560,35 @@ namespace aspect
         // will only be initialized once per model run.
         static bool previous_snapshot_exists = (parameters.resume_computation == true);
 
-        if (previous_snapshot_exists == true)
+        // None of the following requires communication with other processes,
+        // so it can run on a separate thread while the computation continues.
+        // The thread owns copies of everything it needs.
+        auto finish_snapshot = [serialized_data = std::vector<std::string> {oss.str(), statistics_oss.str()},
+                                output_directory = parameters.output_directory,
+                                keep_previous_snapshot = previous_snapshot_exists]()
+        {
+          write_compressed_resume_file (serialized_data,
+                                        output_directory + "restart.resume.z.new");
+          move_snapshot_into_place (output_directory,
+                                    keep_previous_snapshot);
+        };
+
+        if (parameters.write_checkpoint_in_background_thread)
+          checkpoint_writer_thread = std::thread ([this, finish_snapshot = std::move(finish_snapshot)]()
           {
-            move_file (parameters.output_directory + "restart.mesh",
-                       parameters.output_directory + "restart.mesh.old");
-            move_file (parameters.output_directory + "restart.mesh.info",
-                       parameters.output_directory + "restart.mesh.info.old");
-            move_file (parameters.output_directory + "restart.resume.z",
-                       parameters.output_directory + "restart.resume.z.old");
-
-            move_file (parameters.output_directory + "restart.mesh_fixed.data",
-                       parameters.output_directory + "restart.mesh_fixed.data.old");
-
-            if (Utilities::fexists(parameters.output_directory + "restart.mesh_variable.data"))
+            // An exception that leaves the thread would call std::terminate(),
+            // so store it instead and rethrow it when we join the thread.
+            try
               {
-                move_file (parameters.output_directory + "restart.mesh_variable.data",
-                           parameters.output_directory + "restart.mesh_variable.data.old");
+                finish_snapshot();
               }
-
-          }
-
-        move_file (parameters.output_directory + "restart.mesh.new",
-                   parameters.output_directory + "restart.mesh");
-        move_file (parameters.output_directory + "restart.mesh.new.info",
-                   parameters.output_directory + "restart.mesh.info");
-        move_file (parameters.output_directory + "restart.resume.z.new",
-                   parameters.output_directory + "restart.resume.z");
-
-        move_file (parameters.output_directory + "restart.mesh.new_fixed.data",
-                   parameters.output_directory + "restart.mesh_fixed.data");
-
-        if (Utilities::fexists(parameters.output_directory + "restart.mesh.new_variable.data"))
-          {
-            move_file (parameters.output_directory + "restart.mesh.new_variable.data",
-                       parameters.output_directory + "restart.mesh_variable.data");
-          }
-
+            catch (...)
+              {
+                checkpoint_writer_exception = std::current_exception();
+              }
+          });
+        else
+          finish_snapshot();
 
         // from now on, we know that if we get into this
         // function again that a snapshot has previously
@@ -428,7 +596,26 @@ namespace aspect
         previous_snapshot_exists = true;
       }
 
-    pcout << "*** Snapshot created!" << std::endl << std::endl;
+    if (parameters.write_checkpoint_in_background_thread)
+      pcout << "*** Snapshot created, writing it to disk in the background!" << std::endl << std::endl;
+    else
+      pcout << "*** Snapshot created!" << std::endl << std::endl;
+  }
+
+
+
+  template <int dim>
+  void Simulator<dim>::wait_for_checkpoint_writer_thread()
+  {
+    if (checkpoint_writer_thread.joinable())
+      checkpoint_writer_thread.join();
+
+    if (checkpoint_writer_exception)
+      {
+        const std::exception_ptr exception = checkpoint_writer_exception;
+        checkpoint_writer_exception = nullptr;
+        std::rethrow_exception (exception);
+      }
   }
 
 
@@ -473,36 +660,67 @@ namespace aspect
     try
       {
 #ifdef DEAL_II_WITH_ZLIB
-        const std::string restart_data
-          = Utilities::read_and_distribute_file_content (parameters.output_directory + "restart.resume.z",
-                                                         mpi_communicator);
-
-        std::istringstream ifs (restart_data);
-
-        uint32_t compression_header[4];
-        ifs.read(reinterpret_cast<char *>(compression_header), 4 * sizeof(compression_header[0]));
-        Assert(compression_header[0]==1, ExcInternalError());
-
-        std::vector<char> compressed(compression_header[3]);
-        std::vector<char> uncompressed(compression_header[1]);
-        ifs.read(&compressed[0],compression_header[3]);
-        uLongf uncompressed_size = compression_header[1];
+        // Only process 0 reads the file. The first section contains the
+        // state that every process needs, and is the only part we send to
+        // the other processes; each of them then uncompresses it
+        // independently. The second section contains the statistics
+        // table, which is only needed on process 0.
+        const unsigned int my_id = Utilities::MPI::this_mpi_process(mpi_communicator);
+
+        std::string global_section;
+        std::string statistics_section;
+        if (my_id == 0)
+          {
+            std::string restart_data
+              = Utilities::read_and_distribute_file_content (parameters.output_directory + "restart.resume.z",
+                                                             MPI_COMM_SELF);
+
+            // Check that the file was written with the same layout that we
+            // expect. Older files do not start with the identifier.
+            const std::size_t version_header_length = resume_file_identifier.size() + sizeof(resume_file_version);
+            uint32_t file_version = 1;
+            if (restart_data.compare (0, resume_file_identifier.size(), resume_file_identifier) == 0
+                && restart_data.size() >= version_header_length)
+              std::memcpy (&file_version,
+                           restart_data.data() + resume_file_identifier.size(),
+                           sizeof(file_version));
+
+            AssertThrow (file_version == resume_file_version,
+                         ExcMessage ("The restart file <" + parameters.output_directory + "restart.resume.z"
+                                     + "> was written in version " + Utilities::to_string(file_version)
+                                     + " of the format of this file, but this version of ASPECT can "
+                                     + "only read version " + Utilities::to_string(resume_file_version)
+                                     + ". Please resume the model with the version of ASPECT that "
+                                     + "created the checkpoint."));
+
+            restart_data.erase (0, version_header_length);
+
+            const std::size_t global_section_length = length_of_first_section (restart_data);
+            AssertThrow (global_section_length > 0,
+                         ExcMessage ("The restart file <" + parameters.output_directory + "restart.resume.z"
+                                     + "> appears to be truncated or corrupted."));
+
+            global_section = restart_data.substr (0, global_section_length);
+            statistics_section = restart_data.substr (global_section_length);
+          }
 
-        const int err = uncompress(reinterpret_cast<Bytef *>(&uncompressed[0]), &uncompressed_size,
-                                   reinterpret_cast<Bytef *>(&compressed[0]), compression_header[3]);
-        AssertThrow (err == Z_OK,
-                     ExcMessage (std::string("Uncompressing the data buffer resulted in an error with code <")
-                                 +
-                                 Utilities::int_to_string(err)));
+        global_section = Utilities::MPI::broadcast (mpi_communicator, global_section, 0);
 
         {
-          std::istringstream ss;
-          ss.str(std::string (&uncompressed[0], uncompressed_size));
+          std::istringstream ss (uncompress_section (global_section));
 
           aspect::iarchive ia (ss);
           load_and_check_critical_parameters(this->parameters, ia);
           ia >> (*this);
         }
+
+        if (my_id == 0 && statistics_section.size() > 0)
+          {
+            std::istringstream ss (uncompress_section (statistics_section));
+
+            aspect::iarchive ia (ss);
+            ia >> statistics;
+          }
 #else
         AssertThrow (false,
                      ExcMessage ("You need to have deal.II configured with the `libz' "
@@ -622,8 +840,11 @@ namespace aspect
     ar &total_walltime_until_last_snapshot;
 
     ar &postprocess_manager;
+    ar &time_stepping_manager;
 
-    ar &statistics;
+    // The statistics table is not serialized here, but separately
+    // in create_snapshot() and resume_from_snapshot() because
+    // only process 0 needs it.
 
     // We do not serialize the statistics_last_write_size and
     // statistics_last_hash variables on purpose. This way, upon
@@ -642,6 +863,7 @@ namespace aspect
 {
 #define INSTANTIATE(dim) \
   template void Simulator<dim>::create_snapshot(); \
+  template void Simulator<dim>::wait_for_checkpoint_writer_thread(); \
   template void Simulator<dim>::resume_from_snapshot();
 
   ASPECT_INSTANTIATE(INSTANTIATE)
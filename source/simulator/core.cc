@@ -42,6 +42,7 @@
 #include <deal.II/base/conditional_ostream.h>
 #include <deal.II/base/quadrature_lib.h>
 #include <deal.II/base/signaling_nan.h>
+#include <deal.II/base/thread_management.h>
 #include <deal.II/lac/block_sparsity_pattern.h>
 #include <deal.II/lac/sparsity_tools.h>
 #include <deal.II/grid/grid_tools.h>
@@ -200,6 +201,7 @@ namespace aspect
     old_time_step (numbers::signaling_nan<double>()),
     timestep_number (numbers::invalid_unsigned_int),
     nonlinear_iteration (numbers::invalid_unsigned_int),
+    n_advection_subcycles (numbers::invalid_unsigned_int),
 
     // We need to disable eliminate_refined_boundary_islands as this leads to
     // a deadlock for deal.II <= 9.2.0 as described in
@@ -235,6 +237,8 @@ namespace aspect
     last_pressure_normalization_adjustment (numbers::signaling_nan<double>()),
     pressure_scaling (numbers::signaling_nan<double>()),
 
+    stokes_preconditioner_monitor (),
+
     rebuild_stokes_matrix (true),
     assemble_newton_stokes_matrix (true),
     assemble_newton_stokes_system (Parameters<dim>::is_defect_correction(parameters.nonlinear_solver)
@@ -573,6 +577,30 @@ namespace aspect
     if (output_statistics_thread.joinable())
       output_statistics_thread.join();
 
+    // likewise, wait for a snapshot that may still be written in the
+    // background (see create_snapshot()). We cannot throw an exception
+    // from a destructor, so if writing the snapshot failed after the
+    // end of run(), just report the error.
+    if (checkpoint_writer_thread.joinable())
+      checkpoint_writer_thread.join();
+    if (checkpoint_writer_exception)
+      {
+        try
+          {
+            std::rethrow_exception (checkpoint_writer_exception);
+          }
+        catch (const std::exception &exc)
+          {
+            std::cerr << "Writing the last snapshot in the background failed: "
+                      << exc.what() << std::endl;
+          }
+        catch (...)
+          {
+            std::cerr << "Writing the last snapshot in the background failed "
+                      << "with an unknown exception." << std::endl;
+          }
+      }
+
     // If an exception is being thrown (for example due to AssertThrow()), we
     // might end up here with currently active timing sections. The destructor
     // of TimerOutput does MPI communication, which can lead to deadlocks,
@@ -601,6 +629,7 @@ namespace aspect
     }
 
     nonlinear_iteration = 0;
+    n_advection_subcycles = numbers::invalid_unsigned_int;
 
     signals.start_timestep(*this);
 
@@ -620,8 +649,7 @@ namespace aspect
         TimerOutput::Scope timer (computing_timer, "Setup matrices");
 
         rebuild_sparsity_and_matrices = false;
-        setup_system_matrix (introspection.index_sets.system_partitioning);
-        setup_system_preconditioner (introspection.index_sets.system_partitioning);
+        setup_system_matrices (introspection.index_sets.system_partitioning);
         rebuild_stokes_matrix = rebuild_stokes_preconditioner = true;
       }
 
@@ -1173,28 +1201,10 @@ namespace aspect
 
 
   template <int dim>
-  void Simulator<dim>::
-  setup_system_preconditioner (const std::vector<IndexSet> &system_partitioning)
+  Table<2,DoFTools::Coupling>
+  Simulator<dim>::
+  setup_system_preconditioner_coupling () const
   {
-    Amg_preconditioner.reset ();
-    Mp_preconditioner.reset ();
-    system_preconditioner_matrix.clear ();
-
-    // The preconditioner matrix is only used for the Stokes block (velocity and Schur complement)
-    // and only needed if we actually solve iteratively and matrix-based
-    if (solver_scheme_solves_stokes_equations(parameters) == false)
-      return;
-    else if (parameters.stokes_solver_type == Parameters<dim>::StokesSolverType::block_gmg)
-      return;
-    else if (parameters.stokes_solver_type == Parameters<dim>::StokesSolverType::block_amg)
-      {
-        // continue below
-      }
-    else if (parameters.stokes_solver_type == Parameters<dim>::StokesSolverType::direct_solver)
-      return;
-    else
-      AssertThrow(false, ExcNotImplemented());
-
     Table<2,DoFTools::Coupling> coupling (introspection.n_components,
                                           introspection.n_components);
     coupling.fill (DoFTools::none);
@@ -1203,17 +1213,13 @@ namespace aspect
       = introspection.component_indices;
 
     // velocity-velocity block (only block diagonal) is only
-    // needed if we use the simplified A block preconditioner
+    // needed if we use the simplified A block preconditioner. otherwise
+    // the AMG preconditioner is built from the system matrix, and none of
+    // the assemblers write into this block.
     if (parameters.use_full_A_block_preconditioner == false)
       for (unsigned int d=0; d<dim; ++d)
         coupling[x.velocities[d]][x.velocities[d]] = DoFTools::always;
 
-    // TODO: The newton handler always assembles the preconditioner matrix
-    // even if it is not used. Fix that by modifying the newton assemblers.
-    if (newton_handler.get() != nullptr)
-      for (unsigned int d=0; d<dim; ++d)
-        coupling[x.velocities[d]][x.velocities[d]] = DoFTools::always;
-
     // Schur complement block (pressure - pressure):
     if (parameters.include_melt_transport)
       {
@@ -1237,20 +1243,15 @@ namespace aspect
     // its sparsity pattern here -- the corresponding entries of
     // 'coupling' simply remain at DoFTools::none
 
-    LinearAlgebra::BlockDynamicSparsityPattern sp;
-
-    sp.reinit (system_partitioning,
-               system_partitioning,
-               introspection.index_sets.system_relevant_partitioning,
-               mpi_communicator);
+    return coupling;
+  }
 
-    DoFTools::make_sparsity_pattern (dof_handler,
-                                     coupling, sp,
-                                     current_constraints, false,
-                                     Utilities::MPI::
-                                     this_mpi_process(mpi_communicator));
 
 
+  template <int dim>
+  void Simulator<dim>::
+  setup_system_preconditioner (LinearAlgebra::BlockDynamicSparsityPattern &sp)
+  {
     sp.compress();
 
     // We are not interested in temperature and composition matrices for the
@@ -1282,6 +1283,73 @@ namespace aspect
   }
 
 
+
+  template <int dim>
+  void Simulator<dim>::
+  setup_system_matrices (const std::vector<IndexSet> &system_partitioning)
+  {
+    Amg_preconditioner.reset ();
+    Mp_preconditioner.reset ();
+    system_preconditioner_matrix.clear ();
+
+    // The preconditioner matrix is only used for the Stokes block (velocity and Schur complement)
+    // and only needed if we actually solve iteratively and matrix-based
+    bool need_preconditioner_matrix = false;
+    if (solver_scheme_solves_stokes_equations(parameters))
+      {
+        if (parameters.stokes_solver_type == Parameters<dim>::StokesSolverType::block_amg)
+          need_preconditioner_matrix = true;
+        else
+          AssertThrow(parameters.stokes_solver_type == Parameters<dim>::StokesSolverType::block_gmg
+                      ||
+                      parameters.stokes_solver_type == Parameters<dim>::StokesSolverType::direct_solver,
+                      ExcNotImplemented());
+      }
+
+    // Filling the two sparsity patterns loops over all locally relevant
+    // cells, and the loops for the system matrix and the preconditioner
+    // matrix are independent of each other. We therefore fill the
+    // sparsity pattern of the preconditioner matrix on a separate task
+    // while the current thread sets up the system matrix. Only filling the
+    // patterns happens concurrently: initializing and compressing them, as
+    // well as initializing the matrices, communicates with other processes,
+    // and all of this happens on the current thread.
+    LinearAlgebra::BlockDynamicSparsityPattern preconditioner_sp;
+    const Table<2,DoFTools::Coupling> preconditioner_coupling = setup_system_preconditioner_coupling();
+    Threads::Task<> preconditioner_task;
+
+    if (need_preconditioner_matrix)
+      {
+        preconditioner_sp.reinit (system_partitioning,
+                                  system_partitioning,
+                                  introspection.index_sets.system_relevant_partitioning,
+                                  mpi_communicator);
+
+        // MPI is only initialized for serialized calls, so the task must
+        // not call any MPI function while the current thread communicates.
+        // Determine the subdomain id here rather than on the task.
+        const types::subdomain_id subdomain_id = Utilities::MPI::this_mpi_process(mpi_communicator);
+
+        preconditioner_task = Threads::new_task ([&, subdomain_id]()
+        {
+          DoFTools::make_sparsity_pattern (dof_handler,
+                                           preconditioner_coupling,
+                                           preconditioner_sp,
+                                           current_constraints, false,
+                                           subdomain_id);
+        });
+      }
+
+    setup_system_matrix (system_partitioning);
+
+    if (need_preconditioner_matrix)
+      {
+        preconditioner_task.join ();
+        setup_system_preconditioner (preconditioner_sp);
+      }
+  }
+
+
   template <int dim>
   void Simulator<dim>::compute_initial_velocity_boundary_constraints (AffineConstraints<double> &constraints)
   {
@@ -1396,20 +1464,26 @@ namespace aspect
 
     TimerOutput::Scope timer (computing_timer, "Setup dof systems");
 
-    dof_handler.distribute_dofs(finite_element);
-
-    // Renumber the DoFs hierarchical so that we get the
-    // same numbering if we resume the computation. This
-    // is because the numbering depends on the order the
-    // cells are created.
-    DoFRenumbering::hierarchical (dof_handler);
-    DoFRenumbering::component_wise (dof_handler,
-                                    introspection.get_components_to_blocks());
-
-    // set up the introspection object that stores all sorts of
-    // information about components of the finite element, component
-    // masks, etc
-    setup_introspection();
+    // The sub-phases of the setup below are timed separately in addition,
+    // so that their cost can be told apart after each mesh refinement.
+    {
+      TimerOutput::Scope renumbering_timer (computing_timer, "Setup dof systems, renumbering");
+
+      dof_handler.distribute_dofs(finite_element);
+
+      // Renumber the DoFs hierarchical so that we get the
+      // same numbering if we resume the computation. This
+      // is because the numbering depends on the order the
+      // cells are created.
+      DoFRenumbering::hierarchical (dof_handler);
+      DoFRenumbering::component_wise (dof_handler,
+                                      introspection.get_components_to_blocks());
+
+      // set up the introspection object that stores all sorts of
+      // information about components of the finite element, component
+      // masks, etc
+      setup_introspection();
+    }
 
     // print dof numbers. Do so with 1000s separator since they are frequently
     // large
@@ -1458,29 +1532,33 @@ namespace aspect
       mesh_deformation->setup_dofs();
 
 
-    // Reconstruct the constraint-matrix:
-    constraints.clear();
+    {
+      TimerOutput::Scope constraints_timer (computing_timer, "Setup dof systems, constraints");
+
+      // Reconstruct the constraint-matrix:
+      constraints.clear();
 #if DEAL_II_VERSION_GTE(9,6,0)
-    constraints.reinit (dof_handler.locally_owned_dofs(), introspection.index_sets.system_relevant_set);
+      constraints.reinit (dof_handler.locally_owned_dofs(), introspection.index_sets.system_relevant_set);
 #else
-    constraints.reinit(introspection.index_sets.system_relevant_set);
+      constraints.reinit(introspection.index_sets.system_relevant_set);
 #endif
 
-    // Set up the constraints for periodic boundary conditions:
+      // Set up the constraints for periodic boundary conditions:
 
-    // Note: this has to happen _before_ we do hanging node constraints,
-    // because inconsistent constraints could be generated in parallel otherwise.
-    geometry_model->make_periodicity_constraints(dof_handler,
-                                                 constraints);
+      // Note: this has to happen _before_ we do hanging node constraints,
+      // because inconsistent constraints could be generated in parallel otherwise.
+      geometry_model->make_periodicity_constraints(dof_handler,
+                                                   constraints);
 
-    //  Make hanging node constraints:
-    DoFTools::make_hanging_node_constraints (dof_handler,
-                                             constraints);
+      //  Make hanging node constraints:
+      DoFTools::make_hanging_node_constraints (dof_handler,
+                                               constraints);
 
 
-    compute_initial_velocity_boundary_constraints(constraints);
-    constraints.close();
-    signals.post_compute_no_normal_flux_constraints(triangulation);
+      compute_initial_velocity_boundary_constraints(constraints);
+      constraints.close();
+      signals.post_compute_no_normal_flux_constraints(triangulation);
+    }
 
     // Finally initialize vectors. We delay construction of the sparsity
     // patterns and matrices until we have current_constraints.
@@ -1501,6 +1579,24 @@ namespace aspect
     rebuild_stokes_matrix         = true;
     rebuild_stokes_preconditioner = true;
 
+    // The existing preconditioners were built for the old mesh. Delete them
+    // so that they are set up from scratch, rather than with the aggregation
+    // of the old AMG hierarchy (see build_stokes_preconditioner()).
+    Amg_preconditioner.reset ();
+    Mp_preconditioner.reset ();
+
+    // The viscosities recorded for the adaptive rebuild policy of the Stokes
+    // preconditioner refer to the old mesh, so start over
+    if (parameters.stokes_preconditioner_rebuild_policy
+        == Parameters<dim>::StokesPreconditionerRebuildPolicy::adaptive
+        &&
+        parameters.stokes_solver_type == Parameters<dim>::StokesSolverType::block_amg)
+      {
+        stokes_preconditioner_monitor.log_viscosity.reinit (triangulation.n_active_cells());
+        stokes_preconditioner_monitor.log_viscosity_at_last_rebuild.reinit (triangulation.n_active_cells());
+        stokes_preconditioner_monitor.force_rebuild = true;
+      }
+
     // Setup matrix-free dofs
     if (stokes_matrix_free)
       stokes_matrix_free->setup_dofs();
@@ -1578,6 +1674,21 @@ namespace aspect
     std::list<std::pair<std::string,std::string>>
     output_list = postprocess_manager.execute (statistics);
 
+    // add the decisions of the adaptive rebuild policy of the Stokes
+    // preconditioner since the last time we were here
+    if (parameters.stokes_preconditioner_rebuild_policy
+        == Parameters<dim>::StokesPreconditionerRebuildPolicy::adaptive
+        &&
+        parameters.stokes_solver_type == Parameters<dim>::StokesSolverType::block_amg)
+      {
+        statistics.add_value ("Stokes preconditioner rebuilds",
+                              stokes_preconditioner_monitor.n_rebuilds);
+        statistics.add_value ("Stokes preconditioner reuses",
+                              stokes_preconditioner_monitor.n_reuses);
+        stokes_preconditioner_monitor.n_rebuilds = 0;
+        stokes_preconditioner_monitor.n_reuses = 0;
+      }
+
     // if we are on processor zero, print to screen
     // whatever the postprocessors have generated
     if (Utilities::MPI::this_mpi_process(mpi_communicator)==0)
@@ -1617,7 +1728,13 @@ namespace aspect
     mesh_deformation_trans;
 
     {
-      TimerOutput::Scope timer (computing_timer, "Refine mesh structure, part 1");
+      // Time the individual phases of the mesh refinement separately,
+      // so that it is possible to see which one dominates: computing the
+      // refinement indicators, executing the refinement (which includes
+      // repartitioning the mesh and migrating the solution and particle
+      // data), setting up the new dof systems, and interpolating the
+      // solution onto the new mesh.
+      TimerOutput::Scope timer (computing_timer, "Refine mesh structure, indicators");
 
       Vector<float> estimated_error_per_cell (triangulation.n_active_cells());
       mesh_refinement_manager.execute (estimated_error_per_cell);
@@ -1670,26 +1787,6 @@ namespace aspect
         }
 
 
-      // Next set up whatever is necessary to transfer the solution from old
-      // to new mesh:
-      std::vector<const LinearAlgebra::BlockVector *> x_system
-        = { &solution, &old_solution };
-
-      if (parameters.mesh_deformation_enabled)
-        x_system.push_back(&mesh_deformation->mesh_velocity);
-
-      std::vector<const LinearAlgebra::Vector *> x_fs_system;
-      if (parameters.mesh_deformation_enabled)
-        {
-          x_fs_system.push_back (&mesh_deformation->mesh_displacements);
-          x_fs_system.push_back (&mesh_deformation->old_mesh_displacements);
-          x_fs_system.push_back (&mesh_deformation->initial_topography);
-          mesh_deformation_trans
-            = std::make_unique<parallel::distributed::SolutionTransfer<dim,LinearAlgebra::Vector>>
-              (mesh_deformation->mesh_deformation_dof_handler);
-        }
-
-
       // Possibly store data of plugins associated with cells
       signals.pre_refinement_store_user_data(triangulation);
 
@@ -1715,6 +1812,33 @@ namespace aspect
           pcout << "Skipping mesh refinement, because the mesh did not change.\n" << std::endl;
           return;
         }
+    } // leave the timed section
+
+    {
+      TimerOutput::Scope timer (computing_timer, "Refine mesh structure, migration");
+
+      // Next set up whatever is necessary to transfer the solution from old
+      // to new mesh. Note that the solution vectors, the mesh deformation
+      // vectors, and the data of all plugins that were stored above (e.g.
+      // the particles) are all attached to the triangulation, and are
+      // therefore packed and sent to their new owners together in a single
+      // communication step within execute_coarsening_and_refinement().
+      std::vector<const LinearAlgebra::BlockVector *> x_system
+        = { &solution, &old_solution };
+
+      if (parameters.mesh_deformation_enabled)
+        x_system.push_back(&mesh_deformation->mesh_velocity);
+
+      std::vector<const LinearAlgebra::Vector *> x_fs_system;
+      if (parameters.mesh_deformation_enabled)
+        {
+          x_fs_system.push_back (&mesh_deformation->mesh_displacements);
+          x_fs_system.push_back (&mesh_deformation->old_mesh_displacements);
+          x_fs_system.push_back (&mesh_deformation->initial_topography);
+          mesh_deformation_trans
+            = std::make_unique<parallel::distributed::SolutionTransfer<dim,LinearAlgebra::Vector>>
+              (mesh_deformation->mesh_deformation_dof_handler);
+        }
 
       system_trans.prepare_for_coarsening_and_refinement(x_system);
 
@@ -1729,7 +1853,7 @@ namespace aspect
     setup_dofs ();
 
     {
-      TimerOutput::Scope timer (computing_timer, "Refine mesh structure, part 2");
+      TimerOutput::Scope timer (computing_timer, "Refine mesh structure, solution transfer");
 
       LinearAlgebra::BlockVector distributed_system;
       LinearAlgebra::BlockVector old_distributed_system;
@@ -1772,7 +1896,9 @@ namespace aspect
       // when we set the boundary conditions for advected fields (to determine parts
       // of the boundary with outflow). Therefore, we here set it to the solution
       // vector, but it will be reinitialized the next time the equations are solved.
-      current_linearization_point = distributed_system;
+      // Copy from the ghosted solution vector, which has the same layout, so that
+      // the ghost values do not need to be communicated a second time.
+      current_linearization_point = solution;
 
       // do the same as above, but for the mesh deformation solution
       if (parameters.mesh_deformation_enabled)
@@ -2126,6 +2252,10 @@ namespace aspect
       }
     while (true);
 
+    // make sure the last snapshot was written successfully, if it was
+    // written in the background
+    wait_for_checkpoint_writer_thread();
+
     // we disable automatic summary printing so that it won't happen when
     // throwing an exception. Therefore, we have to do this manually here:
     computing_timer.print_summary ();
@@ -22,92 +22,225 @@
 #include <aspect/simulator/assemblers/interface.h>
 #include <aspect/melt.h>
 
+#include <deal.II/base/quadrature_lib.h>
 #include <deal.II/base/signaling_nan.h>
 #include <deal.II/fe/fe_values.h>
 
 
 namespace aspect
 {
-  /**
-   * Compute the variation in the entropy needed in the definition of the
-   * artificial viscosity used to stabilize the composition/temperature equation.
-   */
   template <int dim>
-  double
-  Simulator<dim>::get_entropy_variation (const double average_field,
-                                         const AdvectionField &advection_field) const
+  std::vector<typename Simulator<dim>::AdvectionStabilizationStatistics>
+  Simulator<dim>::compute_advection_stabilization_statistics (const std::vector<AdvectionField> &advection_fields) const
   {
-    // only do this if we really need entropy
-    // variation. otherwise return something that's obviously
-    // nonsensical
+    const unsigned int n_fields = advection_fields.size();
+    std::vector<AdvectionStabilizationStatistics> statistics (n_fields);
+
+    if (n_fields == 0)
+      return statistics;
+
+    // The temperature and the compositional fields may use different
+    // polynomial degrees, and therefore different quadrature formulas.
+    // Set up FEValues objects for each kind of field that is present
+    // so that all fields can be handled within the same loop over all
+    // cells.
+    bool have_temperature = false;
+    bool have_composition = false;
+    for (const auto &advection_field : advection_fields)
+      if (advection_field.is_temperature())
+        have_temperature = true;
+      else
+        have_composition = true;
+
+    std::vector<FEValuesExtractors::Scalar> extractors;
+    for (const auto &advection_field : advection_fields)
+      extractors.push_back(advection_field.scalar_extractor(introspection));
+
+    const bool use_extrapolation = (timestep_number > 1);
+
+    // First, compute the range of the fields extrapolated from the
+    // previous time steps and the maximal velocity of the previous time
+    // step. We do so on the support points of the elements.
+    {
+      const QIterated<dim> velocity_quadrature (QTrapezoid<1>(),
+                                                parameters.stokes_velocity_degree);
+      const QIterated<dim> temperature_quadrature (QTrapezoid<1>(),
+                                                   introspection.polynomial_degree.temperature);
+      const QIterated<dim> composition_quadrature (QTrapezoid<1>(),
+                                                   introspection.polynomial_degree.compositional_fields);
+
+      FEValues<dim> velocity_fe_values (*mapping, finite_element, velocity_quadrature,
+                                        update_values);
+      std::unique_ptr<FEValues<dim>> temperature_fe_values;
+      if (have_temperature)
+        temperature_fe_values = std::make_unique<FEValues<dim>> (*mapping, finite_element, temperature_quadrature,
+                                                                 update_values);
+      std::unique_ptr<FEValues<dim>> composition_fe_values;
+      if (have_composition)
+        composition_fe_values = std::make_unique<FEValues<dim>> (*mapping, finite_element, composition_quadrature,
+                                                                 update_values);
+
+      std::vector<Tensor<1,dim>> velocity_values(velocity_quadrature.size());
+      std::vector<double> old_field_values;
+      std::vector<double> old_old_field_values;
+
+      // For each field, store the negative minimum and the maximum, so
+      // that all extrema (and the maximal velocity as the last entry) can
+      // be communicated in a single MPI reduction.
+      std::vector<double> local_extrema (2*n_fields+1);
+      for (unsigned int i=0; i<n_fields; ++i)
+        {
+          local_extrema[2*i] = -std::numeric_limits<double>::max();
+          local_extrema[2*i+1] = std::numeric_limits<double>::lowest();
+        }
+      local_extrema[2*n_fields] = 0;
+
+      for (const auto &cell : dof_handler.active_cell_iterators())
+        if (cell->is_locally_owned())
+          {
+            velocity_fe_values.reinit (cell);
+            velocity_fe_values[introspection.extractors.velocities].get_function_values (old_solution,
+                                                                                         velocity_values);
+            for (const auto &velocity : velocity_values)
+              local_extrema[2*n_fields] = std::max (local_extrema[2*n_fields],
+                                                    velocity.norm());
+
+            if (have_temperature)
+              temperature_fe_values->reinit (cell);
+            if (have_composition)
+              composition_fe_values->reinit (cell);
+
+            for (unsigned int i=0; i<n_fields; ++i)
+              {
+                const FEValues<dim> &fe_values = (advection_fields[i].is_temperature() ?
+                                                  *temperature_fe_values :
+                                                  *composition_fe_values);
+                const unsigned int n_q_points = fe_values.n_quadrature_points;
+                old_field_values.resize(n_q_points);
+                old_old_field_values.resize(n_q_points);
+
+                fe_values[extractors[i]].get_function_values (old_solution,
+                                                              old_field_values);
+                if (use_extrapolation)
+                  fe_values[extractors[i]].get_function_values (old_old_solution,
+                                                                old_old_field_values);
+
+                for (unsigned int q=0; q<n_q_points; ++q)
+                  {
+                    const double extrapolated_field =
+                      (use_extrapolation ?
+                       (1. + time_step/old_time_step) * old_field_values[q]-
+                       time_step/old_time_step * old_old_field_values[q]
+                       :
+                       old_field_values[q]);
+
+                    local_extrema[2*i] = std::max (local_extrema[2*i],
+                                                   -extrapolated_field);
+                    local_extrema[2*i+1] = std::max (local_extrema[2*i+1],
+                                                     extrapolated_field);
+                  }
+              }
+          }
+
+      std::vector<double> global_extrema (local_extrema.size());
+      Utilities::MPI::max (local_extrema, mpi_communicator, global_extrema);
+
+      for (unsigned int i=0; i<n_fields; ++i)
+        {
+          statistics[i].field_range = std::make_pair(-global_extrema[2*i], global_extrema[2*i+1]);
+          statistics[i].entropy_variation = numbers::signaling_nan<double>();
+          statistics[i].max_velocity = global_extrema[2*n_fields];
+        }
+    }
+
+    // Then compute the variation of the entropy on Gauss quadrature
+    // points, but only if we really need it.
     if (parameters.stabilization_alpha != 2)
-      return numbers::signaling_nan<double>();
-
-    // record maximal entropy on Gauss quadrature points
-    const Quadrature<dim> &quadrature_formula
-      = (advection_field.is_temperature() ?
-         introspection.quadratures.temperature :
-         introspection.quadratures.compositional_fields);
-    const unsigned int n_q_points = quadrature_formula.size();
-
-    const FEValuesExtractors::Scalar field = advection_field.scalar_extractor(introspection);
-
-    FEValues<dim> fe_values (finite_element, quadrature_formula,
-                             update_values | update_JxW_values);
-    std::vector<double> old_field_values(n_q_points);
-    std::vector<double> old_old_field_values(n_q_points);
-
-    double min_entropy = std::numeric_limits<double>::max(),
-           max_entropy = std::numeric_limits<double>::lowest(),
-           area = 0,
-           entropy_integrated = 0;
-
-    // loop over all locally owned cells and evaluate the entropy
-    // at all quadrature points. keep a running tally of the
-    // integral over the entropy as well as the area and the
-    // maximal and minimal entropy
-    for (const auto &cell : dof_handler.active_cell_iterators())
-      if (cell->is_locally_owned())
+      return statistics;
+
+    {
+      std::unique_ptr<FEValues<dim>> temperature_fe_values;
+      if (have_temperature)
+        temperature_fe_values = std::make_unique<FEValues<dim>> (finite_element, introspection.quadratures.temperature,
+                                                                 update_values | update_JxW_values);
+      std::unique_ptr<FEValues<dim>> composition_fe_values;
+      if (have_composition)
+        composition_fe_values = std::make_unique<FEValues<dim>> (finite_element, introspection.quadratures.compositional_fields,
+                                                                 update_values | update_JxW_values);
+
+      std::vector<double> old_field_values;
+      std::vector<double> old_old_field_values;
+
+      // For each field, keep a running tally of the integral over the
+      // entropy and the area, as well as of the maximal and (negative)
+      // minimal entropy. Each group of values is then communicated in one
+      // combined MPI reduction.
+      std::vector<double> local_for_sum (2*n_fields, 0.);
+      std::vector<double> local_for_max (2*n_fields);
+      for (unsigned int i=0; i<n_fields; ++i)
         {
-          fe_values.reinit (cell);
-          fe_values[field].get_function_values (old_solution,
-                                                old_field_values);
-          fe_values[field].get_function_values (old_old_solution,
-                                                old_old_field_values);
-          for (unsigned int q=0; q<n_q_points; ++q)
-            {
-              const double field_value = (old_field_values[q] +
-                                          old_old_field_values[q]) / 2;
-              const double entropy = ((field_value-average_field) *
-                                      (field_value-average_field));
+          local_for_max[2*i] = -std::numeric_limits<double>::max();
+          local_for_max[2*i+1] = std::numeric_limits<double>::lowest();
+        }
 
-              min_entropy = std::min (min_entropy, entropy);
-              max_entropy = std::max (max_entropy, entropy);
+      for (const auto &cell : dof_handler.active_cell_iterators())
+        if (cell->is_locally_owned())
+          {
+            if (have_temperature)
+              temperature_fe_values->reinit (cell);
+            if (have_composition)
+              composition_fe_values->reinit (cell);
 
-              area += fe_values.JxW(q);
-              entropy_integrated += fe_values.JxW(q) * entropy;
-            }
+            for (unsigned int i=0; i<n_fields; ++i)
+              {
+                const FEValues<dim> &fe_values = (advection_fields[i].is_temperature() ?
+                                                  *temperature_fe_values :
+                                                  *composition_fe_values);
+                const unsigned int n_q_points = fe_values.n_quadrature_points;
+                old_field_values.resize(n_q_points);
+                old_old_field_values.resize(n_q_points);
+
+                fe_values[extractors[i]].get_function_values (old_solution,
+                                                              old_field_values);
+                fe_values[extractors[i]].get_function_values (old_old_solution,
+                                                              old_old_field_values);
+
+                const double average_field = (statistics[i].field_range.first +
+                                              statistics[i].field_range.second) / 2;
+
+                for (unsigned int q=0; q<n_q_points; ++q)
+                  {
+                    const double field_value = (old_field_values[q] +
+                                                old_old_field_values[q]) / 2;
+                    const double entropy = ((field_value-average_field) *
+                                            (field_value-average_field));
+
+                    local_for_max[2*i] = std::max (local_for_max[2*i], -entropy);
+                    local_for_max[2*i+1] = std::max (local_for_max[2*i+1], entropy);
+
+                    local_for_sum[2*i] += fe_values.JxW(q) * entropy;
+                    local_for_sum[2*i+1] += fe_values.JxW(q);
+                  }
+              }
+          }
+
+      std::vector<double> global_for_sum (local_for_sum.size());
+      std::vector<double> global_for_max (local_for_max.size());
+      Utilities::MPI::sum (local_for_sum, mpi_communicator, global_for_sum);
+      Utilities::MPI::max (local_for_max, mpi_communicator, global_for_max);
+
+      for (unsigned int i=0; i<n_fields; ++i)
+        {
+          const double average_entropy = global_for_sum[2*i] / global_for_sum[2*i+1];
+
+          // the entropy variation is the maximal deviation of the entropy
+          // everywhere from the average value
+          statistics[i].entropy_variation = std::max(global_for_max[2*i+1] - average_entropy,
+                                                     average_entropy - (-global_for_max[2*i]));
         }
+    }
 
-    // do MPI data exchange: we need to sum over
-    // the two integrals (area,
-    // entropy_integrated), and get the extrema
-    // for maximum and minimum. combine
-    // MPI_Allreduce for two values since that is
-    // an expensive operation
-    const double local_for_sum[2] = { entropy_integrated, area },
-                                    local_for_max[2] = { -min_entropy, max_entropy };
-    double global_for_sum[2], global_for_max[2];
-
-    dealii::Utilities::MPI::sum (local_for_sum, mpi_communicator, global_for_sum);
-    dealii::Utilities::MPI::max (local_for_max, mpi_communicator, global_for_max);
-
-    const double average_entropy = global_for_sum[0] / global_for_sum[1];
-
-    // return the maximal deviation of the entropy everywhere from the
-    // average value
-    return std::max(global_for_max[1] - average_entropy,
-                    average_entropy - (-global_for_max[0]));
+    return statistics;
   }
 
 
@@ -276,12 +409,17 @@ namespace aspect
           skip_EV_dirichlet_boundary_cells = true;
       }
 
-    const std::pair<double,double>
-    global_field_range = get_extrapolated_advection_field_range (advection_field);
-    const double global_entropy_variation = get_entropy_variation ((global_field_range.first +
-                                                                    global_field_range.second) / 2,
-                                                                   advection_field);
-    const double global_max_velocity = get_maximal_velocity(old_solution);
+    // Use the statistics of this field if they have already been computed
+    // together with those of other fields, otherwise compute them now
+    const auto precomputed_statistics = advection_stabilization_statistics.find(advection_field.field_index());
+    const AdvectionStabilizationStatistics statistics
+      = (precomputed_statistics != advection_stabilization_statistics.end() ?
+         precomputed_statistics->second :
+         compute_advection_stabilization_statistics({advection_field})[0]);
+
+    const std::pair<double,double> &global_field_range = statistics.field_range;
+    const double global_entropy_variation = statistics.entropy_variation;
+    const double global_max_velocity = statistics.max_velocity;
 
     UpdateFlags update_flags = update_values |
                                update_gradients |
@@ -701,6 +839,8 @@ namespace aspect
 namespace aspect
 {
 #define INSTANTIATE(dim) \
+  template std::vector<Simulator<dim>::AdvectionStabilizationStatistics> \
+  Simulator<dim>::compute_advection_stabilization_statistics (const std::vector<AdvectionField> &advection_fields) const; \
   template void Simulator<dim>::get_artificial_viscosity (Vector<double> &viscosity_per_cell,  \
                                                           const AdvectionField &advection_field, \
                                                           const bool skip_interior_cells) const; \
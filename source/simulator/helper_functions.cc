@@ -507,6 +507,69 @@ namespace aspect
 
 
 
+  template <int dim>
+  unsigned int Simulator<dim>::get_n_advection_subcycles ()
+  {
+    if (parameters.maximum_advection_subcycling_level == 0 || time_step == 0.)
+      return 1;
+
+    if (n_advection_subcycles != numbers::invalid_unsigned_int)
+      return n_advection_subcycles;
+
+    const QIterated<dim> quadrature_formula (QTrapezoid<1>(),
+                                             parameters.stokes_velocity_degree);
+    const unsigned int n_q_points = quadrature_formula.size();
+
+    FEValues<dim> fe_values (*mapping, finite_element, quadrature_formula, update_values);
+    std::vector<Tensor<1,dim>> velocity_values(n_q_points);
+
+    // compute the largest ratio of velocity and cell size in the same way
+    // as the convection time step model does, but using the velocity
+    // that the advection equations are assembled with
+    double max_local_speed_over_meshsize = 0;
+    for (const auto &cell : dof_handler.active_cell_iterators())
+      if (cell->is_locally_owned())
+        {
+          fe_values.reinit (cell);
+          fe_values[introspection.extractors.velocities].get_function_values (current_linearization_point,
+                                                                              velocity_values);
+
+          double max_local_velocity = 0;
+          for (unsigned int q=0; q<n_q_points; ++q)
+            max_local_velocity = std::max (max_local_velocity,
+                                           velocity_values[q].norm());
+
+          max_local_speed_over_meshsize = std::max (max_local_speed_over_meshsize,
+                                                    max_local_velocity
+                                                    /
+                                                    cell->minimum_vertex_distance());
+        }
+
+    const double max_global_speed_over_meshsize
+      = Utilities::MPI::max (max_local_speed_over_meshsize, mpi_communicator);
+
+    if (max_global_speed_over_meshsize == 0.)
+      {
+        n_advection_subcycles = 1;
+        return n_advection_subcycles;
+      }
+
+    const double cfl_time_step = parameters.CFL_number /
+                                 (parameters.temperature_degree * max_global_speed_over_meshsize);
+
+    // use the smallest power of two that satisfies the CFL condition,
+    // but not more than the user allows
+    const unsigned int max_n_subcycles = (1u << parameters.maximum_advection_subcycling_level);
+    n_advection_subcycles = 1;
+    while (n_advection_subcycles < max_n_subcycles
+           && n_advection_subcycles * cfl_time_step < time_step)
+      n_advection_subcycles *= 2;
+
+    return n_advection_subcycles;
+  }
+
+
+
   template <int dim>
   bool Simulator<dim>::maybe_do_initial_refinement (const unsigned int max_refinement_level)
   {
@@ -708,84 +771,6 @@ namespace aspect
 
 
 
-  template <int dim>
-  std::pair<double,double>
-  Simulator<dim>::
-  get_extrapolated_advection_field_range (const AdvectionField &advection_field) const
-  {
-    const QIterated<dim> quadrature_formula (QTrapezoid<1>(),
-                                             advection_field.polynomial_degree(introspection));
-
-    const unsigned int n_q_points = quadrature_formula.size();
-
-    const FEValuesExtractors::Scalar field = advection_field.scalar_extractor(introspection);
-
-    FEValues<dim> fe_values (*mapping, finite_element, quadrature_formula,
-                             update_values);
-    std::vector<double> old_field_values(n_q_points);
-    std::vector<double> old_old_field_values(n_q_points);
-
-    // This presets the minimum with a bigger
-    // and the maximum with a smaller number
-    // than one that is going to appear. Will
-    // be overwritten in the cell loop or in
-    // the communication step at the
-    // latest.
-    double min_local_field = std::numeric_limits<double>::max(),
-           max_local_field = std::numeric_limits<double>::lowest();
-
-    if (timestep_number > 1)
-      {
-        for (const auto &cell : dof_handler.active_cell_iterators())
-          if (cell->is_locally_owned())
-            {
-              fe_values.reinit (cell);
-              fe_values[field].get_function_values (old_solution,
-                                                    old_field_values);
-              fe_values[field].get_function_values (old_old_solution,
-                                                    old_old_field_values);
-
-              for (unsigned int q=0; q<n_q_points; ++q)
-                {
-                  const double extrapolated_field =
-                    (1. + time_step/old_time_step) * old_field_values[q]-
-                    time_step/old_time_step * old_old_field_values[q];
-
-                  min_local_field = std::min (min_local_field,
-                                              extrapolated_field);
-                  max_local_field = std::max (max_local_field,
-                                              extrapolated_field);
-                }
-            }
-      }
-    else
-      {
-        for (const auto &cell : dof_handler.active_cell_iterators())
-          if (cell->is_locally_owned())
-            {
-              fe_values.reinit (cell);
-              fe_values[field].get_function_values (old_solution,
-                                                    old_field_values);
-
-              for (unsigned int q=0; q<n_q_points; ++q)
-                {
-                  const double extrapolated_field = old_field_values[q];
-
-                  min_local_field = std::min (min_local_field,
-                                              extrapolated_field);
-                  max_local_field = std::max (max_local_field,
-                                              extrapolated_field);
-                }
-            }
-      }
-
-    return std::make_pair(Utilities::MPI::min (min_local_field,
-                                               mpi_communicator),
-                          Utilities::MPI::max (max_local_field,
-                                               mpi_communicator));
-  }
-
-
   template <int dim>
   void Simulator<dim>::interpolate_onto_velocity_system(const TensorFunction<1,dim> &func,
                                                         LinearAlgebra::Vector &vec)
@@ -1705,10 +1690,203 @@ namespace aspect
     heating_model_manager.create_additional_material_model_inputs_and_outputs(in_C, out_C);
     heating_model_manager.create_additional_material_model_inputs_and_outputs(in_T, out_T);
 
-    // Make a loop first over all cells, than over all reaction time steps, and then over
-    // all degrees of freedom in each element to compute the reactions. This is possible
-    // because the reactions only depend on the temperature and composition values at a given
-    // degree of freedom (and are independent of the solution in other points).
+    const bool use_adaptive_steps = (parameters.reaction_solver_type == Parameters<dim>::ReactionSolverType::adaptive_step);
+
+    // Compute the material model and heating model outputs for the current
+    // values of the temperature and the compositional fields in 'in'.
+    auto evaluate_reaction_rates = [&](MaterialModel::MaterialModelInputs<dim> &in,
+                                       MaterialModel::MaterialModelOutputs<dim> &out,
+                                       HeatingModel::HeatingModelOutputs &heating_model_outputs,
+                                       const FEValues<dim> &fe_values)
+    {
+      material_model->fill_additional_material_model_inputs(in, solution, fe_values, introspection);
+
+      material_model->evaluate(in, out);
+      heating_model_manager.evaluate(in, out, heating_model_outputs);
+    };
+
+    // Integrate the reactions over one advection time step for the values of the
+    // temperature and the compositional fields stored in 'in', using either equal
+    // forward Euler steps or adaptive Heun-Euler steps. The values in 'in' are
+    // updated to the end of the time step, and the change of the compositional
+    // fields and of the temperature is added to the 'accumulated_reactions'
+    // vectors if they are given. Returns the number of steps taken.
+    auto integrate_reactions = [&](MaterialModel::MaterialModelInputs<dim> &in,
+                                   MaterialModel::MaterialModelOutputs<dim> &out,
+                                   HeatingModel::HeatingModelOutputs &heating_model_outputs,
+                                   const MaterialModel::ReactionRateOutputs<dim> &reaction_rate_outputs,
+                                   const FEValues<dim> &fe_values,
+                                   std::vector<std::vector<double>> *accumulated_reactions_C,
+                                   std::vector<double> *accumulated_reactions_T) -> unsigned int
+    {
+      const unsigned int n_points = in.n_evaluation_points();
+
+      if (!use_adaptive_steps)
+        {
+          for (unsigned int i=0; i<number_of_reaction_steps; ++i)
+            {
+              evaluate_reaction_rates(in, out, heating_model_outputs, fe_values);
+
+              for (unsigned int j=0; j<n_points; ++j)
+                {
+                  for (unsigned int c=0; c<introspection.n_compositional_fields; ++c)
+                    {
+                      // simple forward euler
+                      in.composition[j][c] = in.composition[j][c]
+                                             + reaction_time_step_size * reaction_rate_outputs.reaction_rates[j][c];
+                      if (accumulated_reactions_C != nullptr)
+                        (*accumulated_reactions_C)[j][c] += reaction_time_step_size * reaction_rate_outputs.reaction_rates[j][c];
+                    }
+                  in.temperature[j] = in.temperature[j]
+                                      + reaction_time_step_size * heating_model_outputs.rates_of_temperature_change[j];
+
+                  if (accumulated_reactions_T != nullptr)
+                    (*accumulated_reactions_T)[j] += reaction_time_step_size * heating_model_outputs.rates_of_temperature_change[j];
+                }
+            }
+
+          return number_of_reaction_steps;
+        }
+
+      // The adaptive scheme uses a forward Euler step as predictor, and the
+      // trapezoidal (Heun) rule as corrector. The difference between the two
+      // is an estimate of the error of the Euler step, which we use to
+      // choose the step size. We continue with the more accurate Heun
+      // solution.
+      std::vector<double> old_temperature (n_points);
+      std::vector<double> temperature_rates (n_points);
+      std::vector<std::vector<double>> old_composition (n_points, std::vector<double>(introspection.n_compositional_fields));
+      std::vector<std::vector<double>> composition_rates (n_points, std::vector<double>(introspection.n_compositional_fields));
+
+      const double relative_tolerance = parameters.reaction_relative_tolerance;
+      const double absolute_tolerance = parameters.reaction_absolute_tolerance;
+
+      double current_time = 0;
+      double step_size = reaction_time_step_size;
+      bool rates_are_current = false;
+      unsigned int n_steps = 0;
+
+      while (current_time < time_step)
+        {
+          const bool is_last_step = (current_time + step_size >= time_step);
+          if (is_last_step)
+            step_size = time_step - current_time;
+
+          // The rates at the beginning of the step only change if the
+          // previous step was accepted.
+          if (!rates_are_current)
+            {
+              evaluate_reaction_rates(in, out, heating_model_outputs, fe_values);
+
+              for (unsigned int j=0; j<n_points; ++j)
+                {
+                  temperature_rates[j] = heating_model_outputs.rates_of_temperature_change[j];
+                  for (unsigned int c=0; c<introspection.n_compositional_fields; ++c)
+                    composition_rates[j][c] = reaction_rate_outputs.reaction_rates[j][c];
+                }
+              rates_are_current = true;
+            }
+
+          // predictor: forward Euler
+          for (unsigned int j=0; j<n_points; ++j)
+            {
+              old_temperature[j] = in.temperature[j];
+              in.temperature[j] = old_temperature[j] + step_size * temperature_rates[j];
+
+              for (unsigned int c=0; c<introspection.n_compositional_fields; ++c)
+                {
+                  old_composition[j][c] = in.composition[j][c];
+                  in.composition[j][c] = old_composition[j][c] + step_size * composition_rates[j][c];
+                }
+            }
+
+          evaluate_reaction_rates(in, out, heating_model_outputs, fe_values);
+
+          // estimate the error of the predictor as its difference to the
+          // corrector, scaled by the tolerance in each point
+          double error = 0;
+          for (unsigned int j=0; j<n_points; ++j)
+            {
+              const double temperature_change = 0.5 * step_size * (temperature_rates[j] +
+                                                                   heating_model_outputs.rates_of_temperature_change[j]);
+              const double new_temperature = old_temperature[j] + temperature_change;
+              error = std::max (error,
+                                std::abs(new_temperature - in.temperature[j])
+                                /
+                                (absolute_tolerance + relative_tolerance * std::max(std::abs(old_temperature[j]),
+                                                                                    std::abs(new_temperature))));
+
+              for (unsigned int c=0; c<introspection.n_compositional_fields; ++c)
+                {
+                  const double composition_change = 0.5 * step_size * (composition_rates[j][c] +
+                                                                       reaction_rate_outputs.reaction_rates[j][c]);
+                  const double new_composition = old_composition[j][c] + composition_change;
+                  error = std::max (error,
+                                    std::abs(new_composition - in.composition[j][c])
+                                    /
+                                    (absolute_tolerance + relative_tolerance * std::max(std::abs(old_composition[j][c]),
+                                                                                        std::abs(new_composition))));
+                }
+            }
+
+          if (error <= 1.0)
+            {
+              // accept the step and continue with the corrector values
+              for (unsigned int j=0; j<n_points; ++j)
+                {
+                  const double temperature_change = 0.5 * step_size * (temperature_rates[j] +
+                                                                       heating_model_outputs.rates_of_temperature_change[j]);
+                  in.temperature[j] = old_temperature[j] + temperature_change;
+                  if (accumulated_reactions_T != nullptr)
+                    (*accumulated_reactions_T)[j] += temperature_change;
+
+                  for (unsigned int c=0; c<introspection.n_compositional_fields; ++c)
+                    {
+                      const double composition_change = 0.5 * step_size * (composition_rates[j][c] +
+                                                                           reaction_rate_outputs.reaction_rates[j][c]);
+                      in.composition[j][c] = old_composition[j][c] + composition_change;
+                      if (accumulated_reactions_C != nullptr)
+                        (*accumulated_reactions_C)[j][c] += composition_change;
+                    }
+                }
+
+              current_time = (is_last_step ? time_step : current_time + step_size);
+              rates_are_current = false;
+              ++n_steps;
+            }
+          else
+            {
+              // reject the step and go back to the values at the beginning of the step
+              for (unsigned int j=0; j<n_points; ++j)
+                {
+                  in.temperature[j] = old_temperature[j];
+                  for (unsigned int c=0; c<introspection.n_compositional_fields; ++c)
+                    in.composition[j][c] = old_composition[j][c];
+                }
+            }
+
+          // The error of the Euler step scales with the square of the step
+          // size. Choose the next step size accordingly, with a safety factor,
+          // and do not change it too abruptly.
+          step_size *= std::min (5.0, std::max (0.2, 0.9 / std::sqrt(std::max(error, 1e-10))));
+
+          // Only check the step size after a rejected step. Accepted steps
+          // can be arbitrarily short, for example the remainder at the end
+          // of the time step, and so can the step size derived from them.
+          AssertThrow (error <= 1.0 || step_size > 1e-12 * time_step,
+                       ExcMessage("The adaptive reaction solver could not find a time step size "
+                                  "that satisfies the given tolerances. Please check the reaction "
+                                  "rates of your model, or increase the tolerances."));
+        }
+
+      return n_steps;
+    };
+
+    // Make a loop first over all cells, and then over all reaction time steps, in
+    // which we update all degrees of freedom in each element to compute the reactions.
+    // This is possible because the reactions only depend on the temperature and
+    // composition values at a given degree of freedom (and are independent of the
+    // solution in other points).
 
     // Note that the values for some degrees of freedom are set more than once in the loop
     // below where we assign the new values to distributed_vector (if they are located on the
@@ -1721,7 +1899,15 @@ namespace aspect
     // back onto the solution vector.
     // So even though we touch some DoF more than once, we always start from the same value, compute the
     // same value, and then overwrite the same value in distributed_vector.
+    // The adaptive scheme chooses its step sizes per cell, so it could in principle
+    // compute slightly different values for a shared DoF on different cells. Each
+    // of these values satisfies the error tolerance, and we keep the one from the
+    // last cell visited.
     // TODO: make this more efficient.
+    unsigned int total_reaction_steps = 0;
+    unsigned int max_reaction_steps = 0;
+    unsigned int n_reaction_cells = 0;
+
     for (const auto &cell : dof_handler.active_cell_iterators())
       if (cell->is_locally_owned())
         {
@@ -1743,51 +1929,19 @@ namespace aspect
           // We can reuse the same material model inputs and outputs structure for each reaction time step.
           // We store the computed updates to temperature and composition in a separate (accumulated_reactions) vector,
           // so that we can later copy it over to the solution vector.
-          for (unsigned int i=0; i<number_of_reaction_steps; ++i)
-            {
-              // Loop over composition element
-              material_model->fill_additional_material_model_inputs(in_C, solution, fe_values_C, introspection);
+          unsigned int n_steps = integrate_reactions(in_C, out_C, heating_model_outputs_C, *reaction_rate_outputs_C, fe_values_C,
+                                                     &accumulated_reactions_C,
+                                                     temperature_and_composition_use_same_fe ? &accumulated_reactions_T : nullptr);
 
-              material_model->evaluate(in_C, out_C);
-              heating_model_manager.evaluate(in_C, out_C, heating_model_outputs_C);
+          if (!temperature_and_composition_use_same_fe)
+            n_steps = std::max (n_steps,
+                                integrate_reactions(in_T, out_T, heating_model_outputs_T, *reaction_rate_outputs_T, fe_values_T,
+                                                    nullptr,
+                                                    &accumulated_reactions_T));
 
-              for (unsigned int j=0; j<dof_handler.get_fe().base_element(introspection.base_elements.compositional_fields).dofs_per_cell; ++j)
-                {
-                  for (unsigned int c=0; c<introspection.n_compositional_fields; ++c)
-                    {
-                      // simple forward euler
-                      in_C.composition[j][c] = in_C.composition[j][c]
-                                               + reaction_time_step_size * reaction_rate_outputs_C->reaction_rates[j][c];
-                      accumulated_reactions_C[j][c] += reaction_time_step_size * reaction_rate_outputs_C->reaction_rates[j][c];
-                    }
-                  in_C.temperature[j] = in_C.temperature[j]
-                                        + reaction_time_step_size * heating_model_outputs_C.rates_of_temperature_change[j];
-
-                  if (temperature_and_composition_use_same_fe)
-                    accumulated_reactions_T[j] += reaction_time_step_size * heating_model_outputs_C.rates_of_temperature_change[j];
-                }
-
-              if (!temperature_and_composition_use_same_fe)
-                {
-                  // loop over temperature element
-                  material_model->fill_additional_material_model_inputs(in_T, solution, fe_values_T, introspection);
-
-                  material_model->evaluate(in_T, out_T);
-                  heating_model_manager.evaluate(in_T, out_T, heating_model_outputs_T);
-
-                  for (unsigned int j=0; j<dof_handler.get_fe().base_element(introspection.base_elements.temperature).dofs_per_cell; ++j)
-                    {
-                      // simple forward euler
-                      in_T.temperature[j] = in_T.temperature[j]
-                                            + reaction_time_step_size * heating_model_outputs_T.rates_of_temperature_change[j];
-                      accumulated_reactions_T[j] += reaction_time_step_size * heating_model_outputs_T.rates_of_temperature_change[j];
-
-                      for (unsigned int c=0; c<introspection.n_compositional_fields; ++c)
-                        in_T.composition[j][c] = in_T.composition[j][c]
-                                                 + reaction_time_step_size * reaction_rate_outputs_T->reaction_rates[j][c];
-                    }
-                }
-            }
+          total_reaction_steps += n_steps;
+          max_reaction_steps = std::max (max_reaction_steps, n_steps);
+          ++n_reaction_cells;
 
           cell->get_dof_indices (local_dof_indices);
 
@@ -1842,10 +1996,24 @@ namespace aspect
 
     initialize_current_linearization_point();
 
-    pcout << "in "
-          << number_of_reaction_steps
-          << " substep(s)."
-          << std::endl;
+    if (use_adaptive_steps)
+      {
+        const double average_reaction_steps
+          = static_cast<double>(Utilities::MPI::sum (total_reaction_steps, mpi_communicator))
+            / std::max (Utilities::MPI::sum (n_reaction_cells, mpi_communicator), 1U);
+
+        pcout << "in "
+              << average_reaction_steps
+              << " substep(s) on average, and at most "
+              << Utilities::MPI::max (max_reaction_steps, mpi_communicator)
+              << " substep(s) per cell."
+              << std::endl;
+      }
+    else
+      pcout << "in "
+            << number_of_reaction_steps
+            << " substep(s)."
+            << std::endl;
   }
 
 
@@ -2514,7 +2682,7 @@ namespace aspect
                                                      const LinearAlgebra::BlockVector &relevant_vector) const; \
   template double Simulator<dim>::compute_pressure_scaling_factor () const; \
   template double Simulator<dim>::get_maximal_velocity (const LinearAlgebra::BlockVector &solution) const; \
-  template std::pair<double,double> Simulator<dim>::get_extrapolated_advection_field_range (const AdvectionField &advection_field) const; \
+  template unsigned int Simulator<dim>::get_n_advection_subcycles (); \
   template void Simulator<dim>::maybe_write_timing_output () const; \
   template bool Simulator<dim>::maybe_write_checkpoint (const time_t, const bool); \
   template bool Simulator<dim>::maybe_do_initial_refinement (const unsigned int max_refinement_level); \
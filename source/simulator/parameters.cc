@@ -143,6 +143,28 @@ namespace aspect
                        "one can choose $c>1$) though a CFL number significantly larger than "
                        "one will yield rather diffusive solutions. Units: None.");
 
+    prm.declare_entry ("Maximum advection subcycling level", "0",
+                       Patterns::Integer (0, 10),
+                       "If set to a value $l>0$, the temperature and compositional "
+                       "fields that are advected with a finite element method are "
+                       "advanced over each time step in up to $2^l$ equal sub-steps, "
+                       "each of which satisfies the CFL condition described in the "
+                       "``CFL number'' parameter for the current velocity. The "
+                       "velocity is kept fixed during these sub-steps, so the Stokes "
+                       "equations are only solved once per time step. In turn, the "
+                       "time step computed by the `convection time step' model is "
+                       "enlarged by a factor of $2^l$. This is useful if a few small "
+                       "cells or a few cells with large velocities would otherwise "
+                       "dictate the time step, and the Stokes solve dominates the "
+                       "cost of each time step. The time step is only enlarged if at "
+                       "least one field is advected with the finite element method. "
+                       "Fields advected with other methods are not sub-cycled; in "
+                       "particular, if the model contains particles, the enlarged time "
+                       "step is limited such that particles do not move by more than "
+                       "``CFL number'' times the cell size per time step. Subcycling can "
+                       "not be used together with melt transport or with fields advected "
+                       "with the `darcy field' method. Units: None.");
+
     prm.declare_entry ("Maximum time step",
                        /* boost::lexical_cast<std::string>(std::numeric_limits<double>::max() /
                                                            year_in_seconds) = */ "5.69e+300",
@@ -272,6 +294,21 @@ namespace aspect
                        "iterations, in other words, if it is set to something other than "
                        "`single Advection, single Stokes' or `single Advection, no Stokes'.");
 
+    prm.declare_entry ("Nonlinear solver acceleration depth", "0",
+                       Patterns::Integer(0),
+                       "If set to a value $m>0$, the Picard iterations for the Stokes system "
+                       "in the `iterated Advection and Stokes' and `single Advection, iterated "
+                       "Stokes' nonlinear solver schemes are accelerated with Anderson "
+                       "acceleration of depth $m$: Instead of continuing with the velocity and "
+                       "pressure of the last Stokes solve, the next nonlinear iteration uses "
+                       "the combination of the last $m+1$ Stokes solutions that minimizes "
+                       "the difference between successive iterates. If this difference "
+                       "increases, the history of previous solutions is discarded. This "
+                       "often reduces the number of nonlinear iterations considerably for "
+                       "strongly nonlinear rheologies, at the cost of storing $2m$ additional "
+                       "vectors of the size of the Stokes system. "
+                       "A value of zero disables the acceleration.");
+
     prm.declare_entry ("Pressure normalization", "surface",
                        Patterns::Selection ("surface|volume|no"),
                        "If and how to normalize the pressure after the solution step. "
@@ -505,6 +542,43 @@ namespace aspect
                            "in the preconditioning used in the GMRES solver. The exact definition of "
                            "this block preconditioner for the Stokes equation can be found in "
                            "\\cite{kronbichler:etal:2012}.");
+
+        prm.declare_entry ("Stokes preconditioner rebuild policy", "always",
+                           Patterns::Selection (StokesPreconditionerRebuildPolicy::get_options_string()),
+                           "This parameter determines when the matrix-based (``block AMG'') Stokes "
+                           "preconditioner is rebuilt after the Stokes matrix has changed. With "
+                           "``always'', the preconditioner is rebuilt every time the matrix is "
+                           "reassembled. With ``adaptive'', the previous preconditioner is reused "
+                           "as long as the number of outer iterations of the last Stokes solve has "
+                           "not grown by more than the factor ``Stokes preconditioner iteration growth'' "
+                           "compared to the first solve after the last rebuild, the cell-averaged "
+                           "viscosity has not changed by more than ``Stokes preconditioner viscosity "
+                           "change'' orders of magnitude in any cell since the last rebuild, and the "
+                           "preconditioner has not been reused more than ``Stokes preconditioner "
+                           "maximum reuses'' times in a row. For smoothly evolving models this can "
+                           "save most of the preconditioner setup time. The number of rebuilds and "
+                           "reuses is written to the statistics file. This parameter is ignored for "
+                           "the other Stokes solver types.");
+
+        prm.declare_entry ("Stokes preconditioner iteration growth", "1.5",
+                           Patterns::Double (1.),
+                           "The factor by which the number of outer iterations of a Stokes solve "
+                           "may exceed the number of iterations of the first solve after the last "
+                           "rebuild of the preconditioner before the preconditioner is rebuilt. "
+                           "Only used if the ``Stokes preconditioner rebuild policy'' is ``adaptive''.");
+
+        prm.declare_entry ("Stokes preconditioner viscosity change", "0.3",
+                           Patterns::Double (0.),
+                           "The largest change of the decadic logarithm of the cell-averaged viscosity "
+                           "in any cell since the last rebuild of the preconditioner for which the "
+                           "preconditioner is still reused. "
+                           "Only used if the ``Stokes preconditioner rebuild policy'' is ``adaptive''.");
+
+        prm.declare_entry ("Stokes preconditioner maximum reuses", "10",
+                           Patterns::Integer (0),
+                           "The maximum number of consecutive times the Stokes preconditioner is "
+                           "reused before it is rebuilt regardless of the other criteria. "
+                           "Only used if the ``Stokes preconditioner rebuild policy'' is ``adaptive''.");
       }
       prm.leave_subsection ();
 
@@ -547,6 +621,18 @@ namespace aspect
         prm.declare_entry ("AMG output details", "false",
                            Patterns::Bool(),
                            "Turns on extra information on the AMG solver. Note that this will generate much more output.");
+
+        prm.declare_entry ("Reuse AMG aggregation", "false",
+                           Patterns::Bool(),
+                           "If true, rebuilding the AMG preconditioners of the matrix-based Stokes solver "
+                           "keeps the aggregates and transfer operators of the existing AMG hierarchies and only "
+                           "recomputes the coarse level matrices and the smoothers from the new matrix entries, "
+                           "which avoids the most expensive part of the AMG setup. This is only possible "
+                           "as long as the sparsity pattern of the matrices does not change, so the AMG "
+                           "preconditioners are always set up from scratch after the mesh has changed. "
+                           "Since the aggregates were determined for the viscosity at the time of the "
+                           "full setup, reusing them may increase the number of iterations if the "
+                           "viscosity changes strongly over time.");
       }
       prm.leave_subsection ();
       prm.enter_subsection ("Operator splitting parameters");
@@ -574,6 +660,51 @@ namespace aspect
                            "this criterion and the ``Reaction time step'', whichever yields the "
                            "smaller time step. "
                            "Units: none.");
+
+        prm.declare_entry ("Reaction solver type", "fixed step",
+                           Patterns::Selection(ReactionSolverType::get_options_string()),
+                           "The method used to integrate the reactions of compositional fields "
+                           "and the temperature over one advection time step in case operator "
+                           "splitting is used. "
+                           "\\begin{itemize} "
+                           "\\item ``fixed step'': Use the explicit Euler method with the number "
+                           "of equal reaction time steps that is given by the ``Reaction time step'' "
+                           "and the ``Reaction time steps per advection step'' parameters. "
+                           "\\item ``adaptive step'': Use the explicit Heun-Euler method with "
+                           "adaptive step size control. The step size is chosen separately for "
+                           "every cell, so that the estimated error of the values in all support "
+                           "points of the cell stays below the tolerance given by the ``Reaction "
+                           "solver relative tolerance'' and the ``Reaction solver absolute "
+                           "tolerance'' parameters. The step size resulting from the ``Reaction time "
+                           "step'' and ``Reaction time steps per advection step'' parameters is "
+                           "only used as the initial step size. This is considerably cheaper "
+                           "than the fixed step method if the reactions are fast only in a small "
+                           "part of the model, as cells without fast reactions are advanced in few "
+                           "large steps. Note that this method is explicit, and therefore "
+                           "only conditionally stable: For stiff reactions, i.e., reactions "
+                           "that drive the solution towards an equilibrium on a time scale "
+                           "much shorter than the time step, the step size is limited by "
+                           "stability rather than by the tolerances, and the method can "
+                           "become as expensive as the fixed step method with very small "
+                           "steps. "
+                           "\\end{itemize}");
+
+        prm.declare_entry ("Reaction solver relative tolerance", "1e-4",
+                           Patterns::Double (0.),
+                           "The relative tolerance of the error estimate of each step of the "
+                           "adaptive reaction solver. This is only used if the ``Reaction "
+                           "solver type'' is ``adaptive step''. "
+                           "Units: none.");
+
+        prm.declare_entry ("Reaction solver absolute tolerance", "1e-8",
+                           Patterns::Double (0.),
+                           "The absolute tolerance of the error estimate of each step of the "
+                           "adaptive reaction solver. This tolerance is used for the temperature "
+                           "and all compositional fields, and determines the accuracy of values "
+                           "close to zero. This is only used if the ``Reaction solver type'' is "
+                           "``adaptive step''. "
+                           "Units: Kelvin for the temperature, the unit of the respective "
+                           "field for compositional fields.");
       }
       prm.leave_subsection ();
       prm.enter_subsection ("Diffusion solver parameters");
@@ -868,6 +999,18 @@ namespace aspect
                          "If 0 and time between checkpoint is not specified, "
                          "checkpointing will not be performed. "
                          "Units: None.");
+      prm.declare_entry ("Write in background thread", "false",
+                         Patterns::Bool (),
+                         "Creating a checkpoint can take a long time for large models, "
+                         "in particular compressing and writing the state of the simulation "
+                         "and of all plugins (including the particles) on the first "
+                         "process, which all other processes have to wait for. If this "
+                         "parameter is set to `true', this part of the work, as well as "
+                         "moving the new checkpoint files into place, happens on a "
+                         "background thread while the computation continues. The mesh and "
+                         "solution vectors are still written before the computation "
+                         "continues. If the model is interrupted before the background "
+                         "thread has finished, the previous checkpoint remains usable.");
     }
     prm.leave_subsection ();
 
@@ -1363,6 +1506,7 @@ namespace aspect
                  ExcInternalError());
 
     CFL_number              = prm.get_double ("CFL number");
+    maximum_advection_subcycling_level = prm.get_integer ("Maximum advection subcycling level");
     use_conduction_timestep = prm.get_bool ("Use conduction timestep");
     convert_to_years        = prm.get_bool ("Use years in output instead of seconds");
     timing_output_frequency = prm.get_integer ("Timing output frequency");
@@ -1436,6 +1580,11 @@ namespace aspect
         use_full_A_block_preconditioner = prm.get_bool ("Use full A block as preconditioner");
         linear_solver_S_block_tolerance = prm.get_double ("Linear solver S block tolerance");
         stokes_gmres_restart_length     = prm.get_integer("GMRES solver restart length");
+
+        stokes_preconditioner_rebuild_policy   = StokesPreconditionerRebuildPolicy::parse(prm.get("Stokes preconditioner rebuild policy"));
+        stokes_preconditioner_iteration_growth = prm.get_double ("Stokes preconditioner iteration growth");
+        stokes_preconditioner_viscosity_change = prm.get_double ("Stokes preconditioner viscosity change");
+        stokes_preconditioner_max_reuses       = prm.get_integer ("Stokes preconditioner maximum reuses");
       }
       prm.leave_subsection ();
 
@@ -1445,6 +1594,7 @@ namespace aspect
         AMG_smoother_sweeps                    = prm.get_integer ("AMG smoother sweeps");
         AMG_aggregation_threshold              = prm.get_double ("AMG aggregation threshold");
         AMG_output_details                     = prm.get_bool ("AMG output details");
+        AMG_reuse_aggregation                  = prm.get_bool ("Reuse AMG aggregation");
       }
       prm.leave_subsection ();
       prm.enter_subsection ("Operator splitting parameters");
@@ -1455,6 +1605,13 @@ namespace aspect
         if (convert_to_years == true)
           reaction_time_step *= year_in_seconds;
         reaction_steps_per_advection_step = prm.get_integer ("Reaction time steps per advection step");
+        reaction_solver_type = ReactionSolverType::parse(prm.get("Reaction solver type"));
+        reaction_relative_tolerance = prm.get_double ("Reaction solver relative tolerance");
+        reaction_absolute_tolerance = prm.get_double ("Reaction solver absolute tolerance");
+        AssertThrow (reaction_solver_type != ReactionSolverType::adaptive_step
+                     || reaction_relative_tolerance > 0 || reaction_absolute_tolerance > 0,
+                     ExcMessage("The adaptive reaction solver requires a positive relative "
+                                "or absolute tolerance."));
       }
       prm.leave_subsection ();
       prm.enter_subsection ("Diffusion solver parameters");
@@ -1466,6 +1623,7 @@ namespace aspect
     prm.leave_subsection ();
 
     nonlinear_tolerance = prm.get_double("Nonlinear solver tolerance");
+    nonlinear_solver_acceleration_depth = prm.get_integer("Nonlinear solver acceleration depth");
 
     max_nonlinear_iterations = prm.get_integer ("Max nonlinear iterations");
     max_nonlinear_iterations_in_prerefinement = prm.get_integer ("Max nonlinear iterations in pre-refinement");
@@ -1606,6 +1764,21 @@ namespace aspect
     }
     prm.leave_subsection();
 
+    AssertThrow (!include_melt_transport || nonlinear_solver_acceleration_depth == 0,
+                 ExcMessage ("Anderson acceleration of the nonlinear solver is not implemented "
+                             "for models with melt transport. Please set the parameter "
+                             "`Nonlinear solver acceleration depth' to zero."));
+
+    AssertThrow (!use_direct_stokes_solver || nonlinear_solver_acceleration_depth == 0,
+                 ExcMessage ("Anderson acceleration of the nonlinear solver is not implemented "
+                             "for the direct Stokes solver. Please set the parameter "
+                             "`Nonlinear solver acceleration depth' to zero."));
+
+    AssertThrow (!include_melt_transport || maximum_advection_subcycling_level == 0,
+                 ExcMessage ("Advection subcycling is not implemented for models "
+                             "with melt transport. Please set the parameter "
+                             "`Maximum advection subcycling level' to zero."));
+
     prm.enter_subsection ("Nullspace removal");
     {
       nullspace_removal = NullspaceRemoval::none;
@@ -1665,6 +1838,7 @@ namespace aspect
     {
       checkpoint_time_secs = prm.get_integer ("Time between checkpoint");
       checkpoint_steps     = prm.get_integer ("Steps between checkpoint");
+      write_checkpoint_in_background_thread = prm.get_bool ("Write in background thread");
 
 #ifndef DEAL_II_WITH_ZLIB
       AssertThrow ((checkpoint_time_secs == 0)
@@ -1937,13 +2111,7 @@ namespace aspect
           else if (x_compositional_field_methods[i] == "particles")
             compositional_field_methods[i] = AdvectionFieldMethod::particles;
           else if (x_compositional_field_methods[i] == "volume of fluid")
-            {
-              AssertThrow (dim==2,
-                           ExcMessage ("The 'volume of fluid' method is currently "
-                                       "only implemented for two-dimensional "
-                                       "computations."));
-              compositional_field_methods[i] = AdvectionFieldMethod::volume_of_fluid;
-            }
+            compositional_field_methods[i] = AdvectionFieldMethod::volume_of_fluid;
           else if (x_compositional_field_methods[i] == "static")
             compositional_field_methods[i] = AdvectionFieldMethod::static_field;
           else if (x_compositional_field_methods[i] == "melt field")
@@ -1990,6 +2158,13 @@ namespace aspect
                        ExcMessage ("The Darcy advection field method only works if there is a compositional field named 'porosity'"));
           AssertThrow (compositional_field_methods[porosity_idx] == AdvectionFieldMethod::fem_darcy_field,
                        ExcMessage ("When using the Darcy advection field method, the porosity field must be advected with the darcy method."));
+
+          // the convection time step is enlarged for subcycled fields, but
+          // only fields advected with the 'field' method are subcycled
+          AssertThrow (maximum_advection_subcycling_level == 0,
+                       ExcMessage ("Advection subcycling is not implemented for fields advected "
+                                   "with the 'darcy field' method. Please set the parameter "
+                                   "`Maximum advection subcycling level' to zero."));
         }
 
       for (const auto &p : x_mapped_particle_properties)
@@ -944,6 +944,18 @@ namespace aspect
                                    solver_control_cheap,
                                    solver_control_expensive);
 
+        // let the adaptive rebuild policy of the preconditioner know how
+        // well it worked this time
+        stokes_preconditioner_monitor.n_iterations
+          = (solver_control_cheap.last_step() != numbers::invalid_unsigned_int ?
+             solver_control_cheap.last_step() :
+             0)
+            + (solver_control_expensive.last_step() != numbers::invalid_unsigned_int ?
+               solver_control_expensive.last_step() :
+               0);
+        if (stokes_preconditioner_monitor.n_iterations_after_last_rebuild == numbers::invalid_unsigned_int)
+          stokes_preconditioner_monitor.n_iterations_after_last_rebuild = stokes_preconditioner_monitor.n_iterations;
+
         // distribute hanging node and
         // other constraints
         current_stokes_constraints.distribute (distributed_stokes_solution);
@@ -26,10 +26,13 @@
 #include <aspect/newton.h>
 #include <aspect/melt.h>
 
+#include <deal.II/lac/full_matrix.h>
 #include <deal.II/numerics/vector_tools.h>
 
 #include <aspect/stokes_matrix_free.h>
 
+#include <deque>
+
 
 namespace aspect
 {
@@ -134,6 +137,235 @@ namespace aspect
 
     };
 
+
+
+    /**
+     * A class that implements Anderson acceleration (also called Anderson
+     * mixing) of the Picard iterations for the Stokes system. Each Picard
+     * iteration is interpreted as the application of a fixed-point map
+     * $g_k = G(x_k)$ to the current velocity and pressure $x_k$. Instead of
+     * continuing with $x_{k+1} = g_k$, Anderson acceleration uses the
+     * combination of the last $m$ results of $G$ that minimizes the
+     * linearized fixed-point residual $f=G(x)-x$, see H. F. Walker and P.
+     * Ni, "Anderson acceleration for fixed-point iterations", SIAM J. Numer.
+     * Anal., 49 (2011).
+     *
+     * The velocity and pressure are combined into a single vector, with the
+     * pressure divided by the pressure scaling factor so that both have
+     * comparable magnitudes. As a safeguard, the history is discarded, and
+     * the iteration continues with the plain Picard update, whenever the
+     * fixed-point residual increases.
+     */
+    class AndersonAcceleration
+    {
+      public:
+        /**
+         * Constructor. @p depth is the maximal number of previous iterations
+         * that are used.
+         */
+        AndersonAcceleration (const unsigned int depth,
+                              const std::vector<IndexSet> &stokes_partitioning,
+                              const unsigned int velocity_block,
+                              const unsigned int pressure_block,
+                              const double pressure_scaling,
+                              const MPI_Comm mpi_communicator)
+          :
+          depth (depth),
+          velocity_block (velocity_block),
+          pressure_block (pressure_block),
+          pressure_scaling (pressure_scaling),
+          input (stokes_partitioning, mpi_communicator),
+          previous_output (stokes_partitioning, mpi_communicator),
+          previous_residual (stokes_partitioning, mpi_communicator),
+          previous_residual_norm (std::numeric_limits<double>::max()),
+          have_previous_iteration (false)
+        {}
+
+        /**
+         * Store the velocity and pressure of @p system_vector as the
+         * input $x_k$ of the next application of the fixed-point map.
+         */
+        void store_input (const LinearAlgebra::BlockVector &system_vector)
+        {
+          extract (system_vector, input);
+        }
+
+        /**
+         * Given the result $g_k$ of the fixed-point map as velocity and
+         * pressure of @p system_vector, replace these by the accelerated
+         * next iterate $x_{k+1}$.
+         */
+        void accelerate (LinearAlgebra::BlockVector &system_vector)
+        {
+          LinearAlgebra::BlockVector output (input);
+          extract (system_vector, output);
+
+          LinearAlgebra::BlockVector residual (output);
+          residual -= input;
+          const double residual_norm = residual.l2_norm();
+
+          if (have_previous_iteration)
+            {
+              if (residual_norm > previous_residual_norm)
+                {
+                  residual_differences.clear();
+                  output_differences.clear();
+                }
+              else
+                {
+                  residual_differences.push_back(residual);
+                  residual_differences.back() -= previous_residual;
+                  output_differences.push_back(output);
+                  output_differences.back() -= previous_output;
+
+                  if (residual_differences.size() > depth)
+                    {
+                      residual_differences.pop_front();
+                      output_differences.pop_front();
+                    }
+                }
+            }
+
+          previous_output = output;
+          previous_residual = residual;
+          previous_residual_norm = residual_norm;
+          have_previous_iteration = true;
+
+          if (residual_differences.empty())
+            return;
+
+          // Solve the least squares problem min |residual - sum_i gamma_i dF_i|
+          // via its normal equations. The system is tiny, but may be badly
+          // conditioned, so add a small regularization.
+          const unsigned int m = residual_differences.size();
+          FullMatrix<double> normal_matrix (m, m);
+          Vector<double> normal_rhs (m);
+          Vector<double> gamma (m);
+          for (unsigned int i=0; i<m; ++i)
+            {
+              normal_rhs(i) = residual_differences[i] * residual;
+              for (unsigned int j=0; j<=i; ++j)
+                normal_matrix(i,j) = normal_matrix(j,i) = residual_differences[i] * residual_differences[j];
+            }
+
+          double trace = 0;
+          for (unsigned int i=0; i<m; ++i)
+            trace += normal_matrix(i,i);
+          for (unsigned int i=0; i<m; ++i)
+            normal_matrix(i,i) += 1e-10 * trace / m;
+
+          normal_matrix.gauss_jordan();
+          normal_matrix.vmult (gamma, normal_rhs);
+
+          for (unsigned int i=0; i<m; ++i)
+            output.add (-gamma(i), output_differences[i]);
+
+          output.block(1) *= pressure_scaling;
+          system_vector.block(velocity_block) = output.block(0);
+          system_vector.block(pressure_block) = output.block(1);
+        }
+
+      private:
+        void extract (const LinearAlgebra::BlockVector &system_vector,
+                      LinearAlgebra::BlockVector &stokes_vector) const
+        {
+          stokes_vector.block(0) = system_vector.block(velocity_block);
+          stokes_vector.block(1) = system_vector.block(pressure_block);
+          stokes_vector.block(1) *= 1./pressure_scaling;
+        }
+
+        const unsigned int depth;
+        const unsigned int velocity_block;
+        const unsigned int pressure_block;
+        const double pressure_scaling;
+
+        LinearAlgebra::BlockVector input;
+        LinearAlgebra::BlockVector previous_output;
+        LinearAlgebra::BlockVector previous_residual;
+        double previous_residual_norm;
+        bool have_previous_iteration;
+
+        std::deque<LinearAlgebra::BlockVector> residual_differences;
+        std::deque<LinearAlgebra::BlockVector> output_differences;
+    };
+  }
+
+
+
+  template <int dim>
+  double Simulator<dim>::assemble_and_solve_advection_field (const AdvectionField &advection_field,
+                                                             double *residual)
+  {
+    const unsigned int block_idx = advection_field.block_index(introspection);
+
+    // Only fields that are advected with the finite element method
+    // are subcycled. Prescribed fields with diffusion do not have an
+    // advection term that would restrict the time step.
+    const unsigned int n_subcycles
+      = (advection_field.advection_method(introspection) == Parameters<dim>::AdvectionFieldMethod::fem_field
+         ?
+         get_n_advection_subcycles()
+         :
+         1);
+
+    if (n_subcycles == 1)
+      {
+        assemble_advection_system (advection_field);
+
+        if (residual)
+          *residual = system_rhs.block(block_idx).l2_norm();
+
+        return solve_advection(advection_field);
+      }
+
+    // Advance the field in n_subcycles equal steps. We temporarily
+    // overwrite the time step sizes, the old solution vectors and the
+    // linearization point of this field, and restore them once we are
+    // done, so that the rest of the time step (and the next one) sees
+    // the usual state.
+    const double full_time_step = time_step;
+    const double full_old_time_step = old_time_step;
+    const LinearAlgebra::Vector saved_old_solution = old_solution.block(block_idx);
+    const LinearAlgebra::Vector saved_old_old_solution = old_old_solution.block(block_idx);
+    const LinearAlgebra::Vector saved_linearization_point = current_linearization_point.block(block_idx);
+
+    // Stabilization statistics that were computed ahead of time for the
+    // full time step are not valid for the sub-steps.
+    advection_stabilization_statistics.erase(advection_field.field_index());
+
+    time_step = full_time_step / n_subcycles;
+
+    double initial_solver_residual = 0.0;
+    for (unsigned int subcycle = 0; subcycle < n_subcycles; ++subcycle)
+      {
+        if (subcycle > 0)
+          {
+            old_time_step = time_step;
+            old_old_solution.block(block_idx) = old_solution.block(block_idx);
+            old_solution.block(block_idx) = solution.block(block_idx);
+          }
+
+        assemble_advection_system (advection_field);
+
+        if (subcycle == 0 && residual)
+          *residual = system_rhs.block(block_idx).l2_norm();
+
+        const double solver_residual = solve_advection(advection_field);
+        if (subcycle == 0)
+          initial_solver_residual = solver_residual;
+
+        // The next sub-step uses the current result as initial guess and
+        // for the evaluation of the material model.
+        current_linearization_point.block(block_idx) = solution.block(block_idx);
+      }
+
+    time_step = full_time_step;
+    old_time_step = full_old_time_step;
+    old_solution.block(block_idx) = saved_old_solution;
+    old_old_solution.block(block_idx) = saved_old_old_solution;
+    current_linearization_point.block(block_idx) = saved_linearization_point;
+
+    return initial_solver_residual;
   }
 
 
@@ -165,12 +397,7 @@ namespace aspect
               old_solution.block(adv_field.block_index(introspection)) = solution.block(adv_field.block_index(introspection));
             }
 
-          assemble_advection_system (adv_field);
-
-          if (residual)
-            *residual = system_rhs.block(introspection.block_indices.temperature).l2_norm();
-
-          current_residual = solve_advection(adv_field);
+          current_residual = assemble_and_solve_advection_field (adv_field, residual);
           break;
         }
 
@@ -246,6 +473,35 @@ namespace aspect
 
     std::vector<AdvectionField> fields_advected_by_particles;
 
+    // Compute the global quantities needed for the stabilization of all
+    // fields that are advected with a continuous finite element method
+    // in one go, rather than separately for every field during its assembly.
+    // Prescribed fields with diffusion are excluded, because their old
+    // solution is only set right before they are assembled.
+    {
+      std::vector<AdvectionField> stabilized_fields;
+      for (unsigned int c=0; c < introspection.n_compositional_fields; ++c)
+        {
+          const AdvectionField adv_field (AdvectionField::composition(c));
+          const typename Parameters<dim>::AdvectionFieldMethod::Kind method = adv_field.advection_method(introspection);
+          if ((method == Parameters<dim>::AdvectionFieldMethod::fem_field ||
+               method == Parameters<dim>::AdvectionFieldMethod::fem_melt_field ||
+               method == Parameters<dim>::AdvectionFieldMethod::fem_darcy_field)
+              && !adv_field.is_discontinuous(introspection))
+            stabilized_fields.push_back(adv_field);
+        }
+
+      if (stabilized_fields.size() > 1)
+        {
+          TimerOutput::Scope timer (computing_timer, "Assemble composition system");
+
+          const std::vector<AdvectionStabilizationStatistics> statistics
+            = compute_advection_stabilization_statistics(stabilized_fields);
+          for (unsigned int i=0; i<stabilized_fields.size(); ++i)
+            advection_stabilization_statistics[stabilized_fields[i].field_index()] = statistics[i];
+        }
+    }
+
     for (unsigned int c=0; c < introspection.n_compositional_fields; ++c)
       {
         const AdvectionField adv_field (AdvectionField::composition(c));
@@ -271,12 +527,8 @@ namespace aspect
                   old_solution.block(adv_field.block_index(introspection)) = solution.block(adv_field.block_index(introspection));
                 }
 
-              assemble_advection_system (adv_field);
-
-              if (residual)
-                (*residual)[c] = system_rhs.block(introspection.block_indices.compositional_fields[c]).l2_norm();
-
-              current_residual[c] = solve_advection(adv_field);
+              current_residual[c] = assemble_and_solve_advection_field (adv_field,
+                                                                        residual ? &(*residual)[c] : nullptr);
 
               // Release the contents of the matrix block we used again:
               const unsigned int block_idx = adv_field.block_index(introspection);
@@ -334,6 +586,8 @@ namespace aspect
           }
       }
 
+    advection_stabilization_statistics.clear();
+
     if (fields_advected_by_particles.size() > 0)
       interpolate_particle_properties(fields_advected_by_particles);
 
@@ -381,8 +635,7 @@ namespace aspect
         compute_current_constraints();
         if (rebuild_sparsity_and_matrices)
           {
-            setup_system_matrix (introspection.index_sets.system_partitioning);
-            setup_system_preconditioner (introspection.index_sets.system_partitioning);
+            setup_system_matrices (introspection.index_sets.system_partitioning);
 
             rebuild_stokes_matrix = rebuild_stokes_preconditioner = true;
           }
@@ -567,6 +820,10 @@ namespace aspect
 
             // start the solve over again and try with a stabilized version
             pcout << "failed, trying again with stabilization" << std::endl;
+
+            // a reused preconditioner may be the reason for the failure,
+            // so do not take any chances on the second attempt
+            stokes_preconditioner_monitor.force_rebuild = true;
             newton_handler->parameters.preconditioner_stabilization = Newton::Parameters::Stabilization::SPD;
             newton_handler->parameters.velocity_block_stabilization = Newton::Parameters::Stabilization::SPD;
 
@@ -655,6 +912,14 @@ namespace aspect
         backup_linearization_point.block(introspection.block_indices.pressure) = current_linearization_point.block(introspection.block_indices.pressure);
         backup_linearization_point.block(introspection.block_indices.velocities) = current_linearization_point.block(introspection.block_indices.velocities);
 
+        // Keep a copy of only the Stokes part of the Newton update, so that
+        // every line search iteration does not have to copy the whole solution.
+        LinearAlgebra::BlockVector newton_update(introspection.index_sets.stokes_partitioning, mpi_communicator);
+        newton_update.block(introspection.block_indices.pressure) = solution.block(introspection.block_indices.pressure);
+        newton_update.block(introspection.block_indices.velocities) = solution.block(introspection.block_indices.velocities);
+
+        LinearAlgebra::BlockVector trial_linearization_point(introspection.index_sets.stokes_partitioning, mpi_communicator);
+
 
         double test_velocity_residual = 0;
         double test_pressure_residual = 0;
@@ -669,22 +934,30 @@ namespace aspect
          */
         do
           {
-            // Reset the current linearization point and the search direction
-            current_linearization_point.block(introspection.block_indices.pressure) = backup_linearization_point.block(introspection.block_indices.pressure);
-            current_linearization_point.block(introspection.block_indices.velocities) = backup_linearization_point.block(introspection.block_indices.velocities);
-
-            LinearAlgebra::BlockVector search_direction = solution;
-            search_direction *= step_length_factor;
+            // Set the current linearization point to the backup plus the scaled search direction
+            trial_linearization_point = backup_linearization_point;
+            trial_linearization_point.add(step_length_factor, newton_update);
 
-            current_linearization_point.block(introspection.block_indices.pressure) += search_direction.block(introspection.block_indices.pressure);
-            current_linearization_point.block(introspection.block_indices.velocities) += search_direction.block(introspection.block_indices.velocities);
+            current_linearization_point.block(introspection.block_indices.pressure) = trial_linearization_point.block(introspection.block_indices.pressure);
+            current_linearization_point.block(introspection.block_indices.velocities) = trial_linearization_point.block(introspection.block_indices.velocities);
 
             // Rebuild the rhs to determine the new residual.
             assemble_newton_stokes_matrix = rebuild_stokes_preconditioner = false;
             rebuild_stokes_matrix = (boundary_velocity_manager.get_active_boundary_velocity_conditions().empty()
                                      == false);
 
-            assemble_stokes_system();
+            // Only the residual is needed here. Temporarily switching off the
+            // Newton derivatives prevents the material model from computing
+            // the viscosity derivatives, which only enter the Newton matrix,
+            // but are often much more expensive than the viscosity itself.
+            {
+              const double newton_derivative_scaling_factor = newton_handler->parameters.newton_derivative_scaling_factor;
+              newton_handler->parameters.newton_derivative_scaling_factor = 0;
+
+              assemble_stokes_system();
+
+              newton_handler->parameters.newton_derivative_scaling_factor = newton_derivative_scaling_factor;
+            }
 
             test_velocity_residual = system_rhs.block(introspection.block_indices.velocities).l2_norm();
             test_pressure_residual = system_rhs.block(introspection.block_indices.pressure).l2_norm();
@@ -1109,6 +1382,15 @@ namespace aspect
     SolverControl nonlinear_solver_control(max_nonlinear_iterations,
                                            parameters.nonlinear_tolerance);
 
+    std::unique_ptr<AndersonAcceleration> anderson_acceleration;
+    if (parameters.nonlinear_solver_acceleration_depth > 0)
+      anderson_acceleration = std::make_unique<AndersonAcceleration> (parameters.nonlinear_solver_acceleration_depth,
+                                                                      introspection.index_sets.stokes_partitioning,
+                                                                      introspection.block_indices.velocities,
+                                                                      introspection.block_indices.pressure,
+                                                                      pressure_scaling,
+                                                                      mpi_communicator);
+
     double relative_residual = std::numeric_limits<double>::max();
     nonlinear_iteration = 0;
 
@@ -1128,6 +1410,9 @@ namespace aspect
           assemble_and_solve_composition(initial_composition_residual,
                                          nonlinear_iteration == 0 ? &initial_composition_residual : nullptr);
 
+        if (anderson_acceleration)
+          anderson_acceleration->store_input (current_linearization_point);
+
         const double relative_nonlinear_stokes_residual =
           assemble_and_solve_stokes(initial_stokes_residual,
                                     nonlinear_iteration == 0 ? &initial_stokes_residual : nullptr);
@@ -1162,6 +1447,19 @@ namespace aspect
               << std::endl
               << std::endl;
 
+        // If we are going to do another nonlinear iteration, continue from the
+        // accelerated iterate rather than from the plain Picard update.
+        if (anderson_acceleration
+            && relative_residual > parameters.nonlinear_tolerance
+            && nonlinear_iteration+1 < max_nonlinear_iterations)
+          {
+            anderson_acceleration->accelerate (solution);
+            current_linearization_point.block(introspection.block_indices.velocities)
+              = solution.block(introspection.block_indices.velocities);
+            current_linearization_point.block(introspection.block_indices.pressure)
+              = solution.block(introspection.block_indices.pressure);
+          }
+
         if (parameters.run_postprocessors_on_nonlinear_iterations)
           postprocess ();
 
@@ -1196,10 +1494,22 @@ namespace aspect
     SolverControl nonlinear_solver_control(max_nonlinear_iterations,
                                            parameters.nonlinear_tolerance);
 
+    std::unique_ptr<AndersonAcceleration> anderson_acceleration;
+    if (parameters.nonlinear_solver_acceleration_depth > 0)
+      anderson_acceleration = std::make_unique<AndersonAcceleration> (parameters.nonlinear_solver_acceleration_depth,
+                                                                      introspection.index_sets.stokes_partitioning,
+                                                                      introspection.block_indices.velocities,
+                                                                      introspection.block_indices.pressure,
+                                                                      pressure_scaling,
+                                                                      mpi_communicator);
+
     double relative_residual = std::numeric_limits<double>::max();
     nonlinear_iteration = 0;
     do
       {
+        if (anderson_acceleration)
+          anderson_acceleration->store_input (current_linearization_point);
+
         relative_residual =
           assemble_and_solve_stokes(initial_stokes_residual,
                                     nonlinear_iteration == 0 ? &initial_stokes_residual : nullptr);
@@ -1209,6 +1519,19 @@ namespace aspect
               << std::endl
               << std::endl;
 
+        // If we are going to do another nonlinear iteration, continue from the
+        // accelerated iterate rather than from the plain Picard update.
+        if (anderson_acceleration
+            && relative_residual > parameters.nonlinear_tolerance
+            && nonlinear_iteration+1 < max_nonlinear_iterations)
+          {
+            anderson_acceleration->accelerate (solution);
+            current_linearization_point.block(introspection.block_indices.velocities)
+              = solution.block(introspection.block_indices.velocities);
+            current_linearization_point.block(introspection.block_indices.pressure)
+              = solution.block(introspection.block_indices.pressure);
+          }
+
         if (parameters.run_postprocessors_on_nonlinear_iterations)
           postprocess ();
 
@@ -1506,6 +1829,7 @@ namespace aspect
 namespace aspect
 {
 #define INSTANTIATE(dim) \
+  template double Simulator<dim>::assemble_and_solve_advection_field(const AdvectionField &, double*); \
   template double Simulator<dim>::assemble_and_solve_temperature(const double &, double*); \
   template std::vector<double> Simulator<dim>::assemble_and_solve_composition(const std::vector<double> &, std::vector<double> *); \
   template double Simulator<dim>::assemble_and_solve_stokes(const double &, double*); \
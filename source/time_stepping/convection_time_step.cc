@@ -21,6 +21,7 @@
 
 #include <aspect/global.h>
 #include <aspect/time_stepping/convection_time_step.h>
+#include <aspect/postprocess/particles.h>
 
 namespace aspect
 {
@@ -80,7 +81,33 @@ namespace aspect
       double min_convection_timestep = std::numeric_limits<double>::max();
 
       if (max_global_speed_over_meshsize != 0.0)
-        min_convection_timestep = this->get_parameters().CFL_number / (this->get_parameters().temperature_degree * max_global_speed_over_meshsize);
+        {
+          min_convection_timestep = this->get_parameters().CFL_number / (this->get_parameters().temperature_degree * max_global_speed_over_meshsize);
+
+          // If the advection equations are subcycled, each time step may be
+          // split into up to 2^l sub-steps that each satisfy the CFL condition.
+          // Only fields advected with the finite element method are subcycled,
+          // so the time step can only be enlarged if there is such a field.
+          bool have_fem_field = (this->get_parameters().temperature_method == Parameters<dim>::AdvectionFieldMethod::fem_field);
+          for (const auto &method : this->get_parameters().compositional_field_methods)
+            if (method == Parameters<dim>::AdvectionFieldMethod::fem_field)
+              have_fem_field = true;
+
+          if (have_fem_field && this->get_parameters().maximum_advection_subcycling_level > 0)
+            {
+              double subcycled_timestep = (1u << this->get_parameters().maximum_advection_subcycling_level)
+                                          * min_convection_timestep;
+
+              // Particles are not subcycled, so they still have to satisfy the
+              // CFL condition with respect to the cell size.
+              if (this->get_postprocess_manager().template
+                  has_matching_postprocessor<const Postprocess::Particles<dim>>())
+                subcycled_timestep = std::min (subcycled_timestep,
+                                               this->get_parameters().CFL_number / max_global_speed_over_meshsize);
+
+              min_convection_timestep = std::max (min_convection_timestep, subcycled_timestep);
+            }
+        }
 
       AssertThrow (min_convection_timestep > 0,
                    ExcMessage("The time step length for the each time step needs to be positive, "
@@ -104,6 +131,14 @@ namespace aspect
                                         "This model computes the convection time step as "
                                         "$ CFL / \\max \\| u \\| / h$ over all cells, "
                                         "where $u$ is the velocity and $h$ is the product of mesh size "
-                                        "and temperature polynomial degree.")
+                                        "and temperature polynomial degree. If advection subcycling "
+                                        "is enabled via the parameter `Maximum advection subcycling "
+                                        "level' $l$ and at least one field is advected with the finite "
+                                        "element method, this time step is multiplied by $2^l$, and the "
+                                        "advection equations are solved in sub-steps that each satisfy "
+                                        "the CFL condition. If the model contains particles, which are "
+                                        "not subcycled, the enlarged time step is limited to "
+                                        "$CFL / \\max \\| u \\| / h$ with the cell size $h$ only, so "
+                                        "that particles do not move by more than one cell per time step.")
   }
 }
@@ -0,0 +1,379 @@
+/*
+  Copyright (C) 2026 by the authors of the ASPECT code.
+
+  This file is part of ASPECT.
+
+  ASPECT is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2, or (at your option)
+  any later version.
+
+  ASPECT is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with ASPECT; see the file LICENSE.  If not see
+  <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <aspect/global.h>
+#include <aspect/time_stepping/error_controlled_time_step.h>
+#include <aspect/mesh_deformation/interface.h>
+
+#include <deal.II/fe/fe_values.h>
+
+#include <algorithm>
+
+namespace aspect
+{
+  namespace TimeStepping
+  {
+    namespace
+    {
+      /**
+       * The estimated errors are those of the extrapolation and of the
+       * explicit surface displacement, which both scale with the square of
+       * the time step size. This is the exponent the PI controller is based
+       * on.
+       */
+      constexpr double error_order = 2.;
+
+      /**
+       * A lower bound for scaled errors, to avoid divisions by zero if a
+       * solution does not change at all.
+       */
+      constexpr double minimal_error = 1e-10;
+    }
+
+
+
+    template <int dim>
+    ErrorControlledTimeStep<dim>::ErrorControlledTimeStep ()
+      :
+      current_error (0.),
+      previous_error (1.),
+      n_repetitions (0)
+    {}
+
+
+
+    template <int dim>
+    double
+    ErrorControlledTimeStep<dim>::compute_field_error () const
+    {
+      const Introspection<dim> &introspection = this->introspection();
+      const Parameters<dim> &parameters = this->get_parameters();
+
+      // collect the blocks of all fields that are solved by a finite
+      // element method, and therefore by the BDF2 scheme
+      std::vector<unsigned int> blocks;
+      const auto is_fem_method = [] (const typename Parameters<dim>::AdvectionFieldMethod::Kind method)
+      {
+        return (method == Parameters<dim>::AdvectionFieldMethod::fem_field
+                || method == Parameters<dim>::AdvectionFieldMethod::fem_melt_field
+                || method == Parameters<dim>::AdvectionFieldMethod::fem_darcy_field);
+      };
+
+      if (is_fem_method(parameters.temperature_method))
+        blocks.push_back (introspection.block_indices.temperature);
+      for (unsigned int c=0; c<introspection.n_compositional_fields; ++c)
+        if (is_fem_method(parameters.compositional_field_methods[c]))
+          blocks.push_back (introspection.block_indices.compositional_fields[c]);
+
+      if (blocks.empty())
+        return 0.;
+
+      const LinearAlgebra::BlockVector &solution = this->get_solution();
+      const LinearAlgebra::BlockVector &old_solution = this->get_old_solution();
+      const LinearAlgebra::BlockVector &old_old_solution = this->get_old_old_solution();
+
+      const double step_ratio = this->get_timestep() / this->get_old_timestep();
+
+      // for each field, compute the maximum, the negative minimum, and the
+      // maximal difference between the solution and the linear extrapolation
+      // of the two previous solutions, so that all of them can be
+      // communicated in one reduction
+      std::vector<double> local_values (3*blocks.size(), -std::numeric_limits<double>::max());
+      for (unsigned int f=0; f<blocks.size(); ++f)
+        {
+          const unsigned int block = blocks[f];
+          for (const types::global_dof_index i : solution.block(block).locally_owned_elements())
+            {
+              const double value = solution.block(block)(i);
+              const double old_value = old_solution.block(block)(i);
+              const double predicted_value = old_value + step_ratio * (old_value - old_old_solution.block(block)(i));
+
+              local_values[3*f]   = std::max (local_values[3*f], value);
+              local_values[3*f+1] = std::max (local_values[3*f+1], -value);
+              local_values[3*f+2] = std::max (local_values[3*f+2], std::abs(value - predicted_value));
+            }
+        }
+
+      std::vector<double> global_values (local_values.size());
+      Utilities::MPI::max (local_values, this->get_mpi_communicator(), global_values);
+
+      double error = 0.;
+      for (unsigned int f=0; f<blocks.size(); ++f)
+        {
+          const double range = global_values[3*f] + global_values[3*f+1];
+          if (range > 0.)
+            error = std::max (error, global_values[3*f+2] / (field_tolerance * range));
+        }
+
+      return error;
+    }
+
+
+
+    template <int dim>
+    double
+    ErrorControlledTimeStep<dim>::compute_topography_error () const
+    {
+      if (this->get_parameters().mesh_deformation_enabled == false)
+        return 0.;
+
+      const std::set<types::boundary_id> &boundary_indicators
+        = this->get_mesh_deformation_handler().get_active_mesh_deformation_boundary_indicators();
+
+      const Quadrature<dim-1> &quadrature = this->introspection().face_quadratures.velocities;
+      FEFaceValues<dim> fe_face_values (this->get_mapping(),
+                                        this->get_fe(),
+                                        quadrature,
+                                        update_values | update_normal_vectors);
+
+      std::vector<Tensor<1,dim>> velocity_values (quadrature.size());
+      std::vector<Tensor<1,dim>> old_velocity_values (quadrature.size());
+
+      // the boundary moves with the normal velocity. the difference between
+      // moving it with the velocity at the end and at the beginning of the
+      // time step is an estimate of the error of the displacement
+      double max_normal_velocity_change = 0.;
+      for (const auto &cell : this->get_dof_handler().active_cell_iterators())
+        if (cell->is_locally_owned() && cell->at_boundary())
+          for (const unsigned int face_no : cell->face_indices())
+            if (cell->face(face_no)->at_boundary()
+                && boundary_indicators.find(cell->face(face_no)->boundary_id()) != boundary_indicators.end())
+              {
+                fe_face_values.reinit (cell, face_no);
+                fe_face_values[this->introspection().extractors.velocities].get_function_values (this->get_solution(),
+                    velocity_values);
+                fe_face_values[this->introspection().extractors.velocities].get_function_values (this->get_old_solution(),
+                    old_velocity_values);
+
+                for (unsigned int q=0; q<quadrature.size(); ++q)
+                  max_normal_velocity_change = std::max (max_normal_velocity_change,
+                                                         std::abs((velocity_values[q] - old_velocity_values[q])
+                                                                  * fe_face_values.normal_vector(q)));
+              }
+
+      max_normal_velocity_change = Utilities::MPI::max (max_normal_velocity_change, this->get_mpi_communicator());
+
+      return 0.5 * this->get_timestep() * max_normal_velocity_change / topography_tolerance;
+    }
+
+
+
+    template <int dim>
+    double
+    ErrorControlledTimeStep<dim>::execute()
+    {
+      // time step zero only computes the initial state, and the step
+      // after it has no second previous solution to extrapolate from
+      // (the old time step size is zero), so there is nothing to
+      // estimate yet. leave the choice to the other limits of the time
+      // step size
+      if (this->get_timestep_number() == 0 || this->get_old_timestep() == 0.)
+        {
+          current_error = 0.;
+          return std::numeric_limits<double>::max();
+        }
+
+      current_error = std::max ({compute_field_error(),
+                                 compute_topography_error(),
+                                 minimal_error
+                                });
+
+      this->get_pcout() << "   Estimated relative time step error: " << current_error << std::endl;
+
+      // the PI controller of Gustafsson, Lundh and Soederlind (1988) in the
+      // form given by Hairer and Wanner
+      const double factor = safety_factor
+                            * std::pow (current_error, -0.7/error_order)
+                            * std::pow (previous_error, 0.4/error_order);
+
+      return this->get_timestep() * std::max (factor, minimum_reduction_factor);
+    }
+
+
+
+    template <int dim>
+    std::pair<Reaction, double>
+    ErrorControlledTimeStep<dim>::determine_reaction (const TimeStepInfo &/*info*/)
+    {
+      if (current_error > 1. && n_repetitions < maximum_repetitions)
+        {
+          ++n_repetitions;
+
+          const double factor = std::max (safety_factor * std::pow (current_error, -1./error_order),
+                                          minimum_reduction_factor);
+          return std::make_pair (Reaction::repeat_step,
+                                 this->get_timestep() * factor);
+        }
+
+      n_repetitions = 0;
+      if (current_error > 0.)
+        previous_error = current_error;
+
+      return std::make_pair (Reaction::advance,
+                             std::numeric_limits<double>::max());
+    }
+
+
+
+    template <int dim>
+    void
+    ErrorControlledTimeStep<dim>::declare_parameters (ParameterHandler &prm)
+    {
+      prm.enter_subsection("Time stepping");
+      {
+        prm.enter_subsection("Error controlled time step");
+        {
+          prm.declare_entry("Field error tolerance", "1e-3",
+                            Patterns::Double (0., 1.),
+                            "The tolerance for the estimated error of the temperature and "
+                            "compositional fields in one time step, relative to the range of "
+                            "values of each field. A time step whose estimated error exceeds "
+                            "this tolerance is repeated with a smaller step size.");
+
+          prm.declare_entry("Topography error tolerance", "10.",
+                            Patterns::Double (0.),
+                            "The tolerance for the estimated error of the surface topography in "
+                            "one time step. Only used if the mesh is deformed. Units: \\si{\\meter}.");
+
+          prm.declare_entry("Safety factor", "0.9",
+                            Patterns::Double (0., 1.),
+                            "A factor by which the step size computed by the controller is "
+                            "multiplied, so that the next time step is likely to be accepted.");
+
+          prm.declare_entry("Minimum reduction factor", "0.2",
+                            Patterns::Double (0., 1.),
+                            "The smallest factor by which the time step size may be reduced from "
+                            "one time step to the next, or when a time step is repeated.");
+
+          prm.declare_entry("Maximum number of repetitions", "5",
+                            Patterns::Integer (0),
+                            "The maximal number of times a time step is repeated in a row because "
+                            "its estimated error is too large. After that many repetitions, the "
+                            "time step is accepted regardless of its error.");
+        }
+        prm.leave_subsection();
+      }
+      prm.leave_subsection();
+    }
+
+
+
+    template <int dim>
+    void
+    ErrorControlledTimeStep<dim>::parse_parameters (ParameterHandler &prm)
+    {
+      prm.enter_subsection("Time stepping");
+      {
+        prm.enter_subsection("Error controlled time step");
+        {
+          field_tolerance = prm.get_double("Field error tolerance");
+          topography_tolerance = prm.get_double("Topography error tolerance");
+          safety_factor = prm.get_double("Safety factor");
+          minimum_reduction_factor = prm.get_double("Minimum reduction factor");
+          maximum_repetitions = prm.get_integer("Maximum number of repetitions");
+
+          AssertThrow (field_tolerance > 0. && topography_tolerance > 0.,
+                       ExcMessage("The error tolerances of the error controlled time step "
+                                  "need to be positive."));
+        }
+        prm.leave_subsection();
+
+        // the error estimate says nothing about the stability of the
+        // advection schemes, which is what the convection time step ensures
+        const std::vector<std::string> model_names
+          = Utilities::split_string_list(prm.get("List of model names"));
+        AssertThrow (std::find (model_names.begin(), model_names.end(), "convection time step") != model_names.end(),
+                     ExcMessage("The 'error controlled time step' model needs to be combined with the "
+                                "'convection time step' model in 'Time stepping/List of model names'."));
+      }
+      prm.leave_subsection();
+    }
+
+
+
+    template <int dim>
+    template <class Archive>
+    void ErrorControlledTimeStep<dim>::serialize (Archive &ar, const unsigned int)
+    {
+      ar &previous_error
+      & n_repetitions;
+    }
+
+
+
+    template <int dim>
+    void
+    ErrorControlledTimeStep<dim>::save (std::map<std::string, std::string> &status_strings) const
+    {
+      std::ostringstream os;
+      aspect::oarchive oa (os);
+      oa << (*this);
+
+      status_strings["ErrorControlledTimeStep"] = os.str();
+    }
+
+
+
+    template <int dim>
+    void
+    ErrorControlledTimeStep<dim>::load (const std::map<std::string, std::string> &status_strings)
+    {
+      // see if something was saved
+      if (status_strings.find("ErrorControlledTimeStep") != status_strings.end())
+        {
+          std::istringstream is (status_strings.find("ErrorControlledTimeStep")->second);
+          aspect::iarchive ia (is);
+          ia >> (*this);
+        }
+    }
+
+  }
+}
+
+// explicit instantiations
+namespace aspect
+{
+  namespace TimeStepping
+  {
+    ASPECT_REGISTER_TIME_STEPPING_MODEL(ErrorControlledTimeStep,
+                                        "error controlled time step",
+                                        "This model chooses the time step size based on an estimate "
+                                        "of the time discretization error of the last time step. "
+                                        "The error of the temperature and compositional fields is "
+                                        "estimated by the difference between the computed solution "
+                                        "and the linear extrapolation of the two previous solutions, "
+                                        "relative to the range of each field. The error of the surface "
+                                        "topography (if the mesh is deformed) is estimated by the "
+                                        "difference between moving the boundary with the new and "
+                                        "the old velocity. The next time step size is computed from "
+                                        "the errors of the current and the previous time step by a "
+                                        "proportional-integral (PI) controller, and a time step whose "
+                                        "error exceeds the tolerance is repeated with a smaller step "
+                                        "size.\n\n"
+                                        "Since the advection schemes are only stable for time steps "
+                                        "that satisfy the CFL condition, this model must be combined "
+                                        "with the ``convection time step'' model, and the smaller of "
+                                        "the two step sizes is used. Together with subcycling of the "
+                                        "advection equations (see `Maximum advection subcycling "
+                                        "level'), which enlarges the convection time step, this allows "
+                                        "for larger time steps during quasi-steady phases of a model.")
+  }
+}
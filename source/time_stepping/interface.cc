@@ -83,6 +83,20 @@ namespace aspect
 
 
 
+    template <int dim>
+    void
+    Interface<dim>::save (std::map<std::string,std::string> &) const
+    {}
+
+
+
+    template <int dim>
+    void
+    Interface<dim>::load (const std::map<std::string,std::string> &)
+    {}
+
+
+
     template <int dim>
     void
     Manager<dim>::
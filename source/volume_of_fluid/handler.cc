@@ -408,12 +408,13 @@ namespace aspect
   VolumeOfFluidHandler<dim>::initialize (ParameterHandler &/*prm*/)
   {
     // Do checks on required assumptions
-    AssertThrow(dim==2,
-                ExcMessage("Volume of Fluid Interface Tracking is currently only functional for dim=2."));
-
     AssertThrow(this->get_parameters().CFL_number < 1.0,
                 ExcMessage("Volume of Fluid Interface Tracking requires CFL < 1."));
 
+    AssertThrow(this->get_parameters().maximum_advection_subcycling_level == 0,
+                ExcMessage("Volume of Fluid Interface Tracking requires CFL < 1, "
+                           "and can therefore not be combined with advection subcycling."));
+
     AssertThrow(!this->get_material_model().is_compressible(),
                 ExcMessage("Volume of Fluid Interface Tracking currently assumes incompressibility."));
 
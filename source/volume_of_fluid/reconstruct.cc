@@ -419,19 +419,366 @@ namespace aspect
 
 
   template <>
-  void VolumeOfFluidHandler<3>::update_volume_of_fluid_normals (const VolumeOfFluidField<3> &/*field*/,
-                                                                LinearAlgebra::BlockVector &/*solution*/)
+  void VolumeOfFluidHandler<3>::update_volume_of_fluid_normals (const VolumeOfFluidField<3> &field,
+                                                                LinearAlgebra::BlockVector &solution)
   {
-    Assert(false, ExcNotImplemented());
+    const unsigned int dim = 3;
+    const unsigned int max_degree = 1;
+
+    LinearAlgebra::BlockVector initial_solution;
+
+    TimerOutput::Scope timer (sim.computing_timer, "Reconstruct VolumeOfFluid interfaces");
+
+    initial_solution.reinit(sim.system_rhs, false);
+
+    // Boundary reference
+    typename DoFHandler<dim>::active_cell_iterator endc =
+      this->get_dof_handler().end ();
+
+    // Number of cells in the local reconstruction stencil
+    const unsigned int stencil_side_cell_count = 3;
+    const unsigned int n_cells_local_stencil = 27;
+
+    Vector<double> local_volume_of_fluids (n_cells_local_stencil);
+    std::vector<Point<dim>> stencil_unit_cell_centers (n_cells_local_stencil);
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> neighbor_cells(n_cells_local_stencil);
+
+    // Sums of the volume fractions over the planes of the stencil that are
+    // normal to each direction, indexed as
+    // [stencil_side_cell_count * normal_dim + ind]
+    std::vector<double> plane_sums (dim * stencil_side_cell_count);
+
+    // For each dimension we consider 3 divided differences of the plane sums
+    // in each of the two other dimensions, and all combinations of these
+    const unsigned int n_differences = 3;
+    const unsigned int n_candidate_normals_per_dim = n_differences * n_differences;
+
+    // Named variable for number of candidate interface normal vectors for the reconstruction
+    const unsigned int n_candidate_normals = dim*n_candidate_normals_per_dim+1;
+    std::vector<Tensor<1, dim, double>> normals (n_candidate_normals);
+    std::vector<double> d_vals (n_candidate_normals);
+    std::vector<double> errs (n_candidate_normals);
+
+    // Variables to do volume calculations
+
+    const QGauss<dim> quadrature(max_degree);
+
+    const FiniteElement<dim> &system_fe = this->get_fe();
+
+    FEValues<dim> fevalues(this->get_mapping(), system_fe, quadrature,
+                           update_JxW_values);
+
+    // Normal holding vars
+    Point<dim> reconstruction_stencil_unit_cell_center;
+    Tensor<1, dim, double> normal;
+    double d;
+
+    for (unsigned int i=0; i<dim; ++i)
+      reconstruction_stencil_unit_cell_center[i] = 0.5;
+
+    std::vector<types::global_dof_index> cell_dof_indices (system_fe.dofs_per_cell);
+    std::vector<types::global_dof_index> local_dof_indices (system_fe.dofs_per_cell);
+
+    const FEVariable<dim> &volume_of_fluid_var = field.volume_fraction;
+    const unsigned int volume_of_fluid_c_index = volume_of_fluid_var.first_component_index;
+    const unsigned int volume_of_fluid_ind
+      = this->get_fe().component_to_system_index(volume_of_fluid_c_index, 0);
+
+    const FEVariable<dim> &volume_of_fluidN_var = field.reconstruction;
+    const unsigned int volume_of_fluidN_c_index = volume_of_fluidN_var.first_component_index;
+    const unsigned int volume_of_fluidN_blockidx = volume_of_fluidN_var.block_index;
+
+    const FEVariable<dim> &volume_of_fluidLS_var = field.level_set;
+    const unsigned int volume_of_fluidLS_c_index = volume_of_fluidLS_var.first_component_index;
+    const unsigned int n_volume_of_fluidLS_dofs = volume_of_fluidLS_var.fe->dofs_per_cell;
+    const unsigned int volume_of_fluidLS_blockidx = volume_of_fluidLS_var.block_index;
+
+    // Return the neighbor of the given cell across the given face if it is
+    // active and on the same level as the given cell, and endc otherwise
+    // (including if the given cell is itself endc).
+    const auto same_level_neighbor = [&](const typename DoFHandler<dim>::active_cell_iterator &current_cell,
+                                         const unsigned int neighbor_no)
+    {
+      typename DoFHandler<dim>::active_cell_iterator result = endc;
+      if (current_cell == endc)
+        return result;
+
+      const typename DoFHandler<dim>::face_iterator face = current_cell->face (neighbor_no);
+      if ((face->at_boundary() && !current_cell->has_periodic_neighbor(neighbor_no)) ||
+          face->has_children())
+        return result;
+
+      const typename DoFHandler<dim>::cell_iterator neighbor =
+        current_cell->neighbor_or_periodic_neighbor(neighbor_no);
+      if (neighbor->level() == current_cell->level() &&
+          neighbor->is_active())
+        result = neighbor;
+
+      return result;
+    };
+
+    //Iterate over cells
+    for (auto cell : this->get_dof_handler().active_cell_iterators ())
+      {
+        if (!cell->is_locally_owned ())
+          continue;
+
+        // Obtain data for this cell and neighbors
+        cell->get_dof_indices (local_dof_indices);
+        const double cell_volume_of_fluid = solution(local_dof_indices[volume_of_fluid_ind]);
+
+        normal = 0;
+        d = -1.0;
+
+        if (cell_volume_of_fluid > 1.0 - volume_fraction_threshold)
+          {
+            d = 1.0;
+            initial_solution(local_dof_indices[volume_of_fluid_ind]) = 1.0;
+          }
+        else if (cell_volume_of_fluid < volume_fraction_threshold)
+          {
+            d = -1.0;
+            initial_solution(local_dof_indices[volume_of_fluid_ind]) = 0.0;
+          }
+        else
+          {
+            initial_solution(local_dof_indices[volume_of_fluid_ind]) = cell_volume_of_fluid;
+
+            // Get references to neighboring cells to build stencil references
+            //
+            // As in 2d, we obtain the cells by walking from the current cell
+            // first in x-direction, then in y-direction, and then in
+            // z-direction. The stencil index of the cell at position
+            // (i, j, k) is 9*k + 3*j + i.
+            for (unsigned int i = 0; i < stencil_side_cell_count; ++i)
+              {
+                const typename DoFHandler<dim>::active_cell_iterator x_cell
+                  = (i == 1) ? cell : same_level_neighbor(cell, i/2);
+
+                for (unsigned int j = 0; j < stencil_side_cell_count; ++j)
+                  {
+                    const typename DoFHandler<dim>::active_cell_iterator y_cell
+                      = (j == 1) ? x_cell : same_level_neighbor(x_cell, 2+j/2);
+
+                    for (unsigned int k = 0; k < stencil_side_cell_count; ++k)
+                      {
+                        const typename DoFHandler<dim>::active_cell_iterator curr
+                          = (k == 1) ? y_cell : same_level_neighbor(y_cell, 4+k/2);
+
+                        const unsigned int stencil_index = 9 * k + 3 * j + i;
+                        if (curr != endc)
+                          {
+                            // Cell reference is valid, so get data
+                            curr->get_dof_indices (cell_dof_indices);
+                            stencil_unit_cell_centers[stencil_index] = Point<dim> (-1.0 + i,
+                                                                                   -1.0 + j,
+                                                                                   -1.0 + k);
+                          }
+                        else
+                          {
+                            // Cell reference is invalid, so replace with current
+                            // cell to reduce branching complexity in the later
+                            // algorithm
+                            cell->get_dof_indices (cell_dof_indices);
+                            stencil_unit_cell_centers[stencil_index] = Point<dim> (0.0,
+                                                                                   0.0,
+                                                                                   0.0);
+                          }
+                        local_volume_of_fluids (stencil_index) = solution (cell_dof_indices[volume_of_fluid_ind]);
+                        neighbor_cells[stencil_index] = curr;
+                      }
+                  }
+              }
+
+            // Gather cell plane sums
+            for (unsigned int i = 0; i < dim * stencil_side_cell_count; ++i)
+              plane_sums[i] = 0.0;
+
+            for (unsigned int i = 0; i < stencil_side_cell_count; ++i)
+              for (unsigned int j = 0; j < stencil_side_cell_count; ++j)
+                for (unsigned int k = 0; k < stencil_side_cell_count; ++k)
+                  {
+                    const double value = local_volume_of_fluids (9 * k + 3 * j + i);
+                    plane_sums[stencil_side_cell_count * 0 + i] += value;
+                    plane_sums[stencil_side_cell_count * 1 + j] += value;
+                    plane_sums[stencil_side_cell_count * 2 + k] += value;
+                  }
+
+            // Calculate normal vectors for the 27 candidates from the
+            // height function approach, which generalizes the efficient
+            // least squares approach used in 2d
+            //
+            // For each height direction dh, the plane sums normal to the two
+            // other directions are 3 times the average height of the fluid
+            // column in direction dh. Labeling the plane sums as
+            // 0 1 2
+            // L C R
+            //
+            // we consider the slopes of the height implied by the 3
+            // divided differences
+            //
+            // L-C/1
+            // C-R/1
+            // L-R/2
+            //
+            // in each of the two other directions.
+            for (unsigned int dh = 0; dh < dim; ++dh)
+              {
+                // Get indices of the other dimensions
+                const unsigned int du = (dh == 0) ? 1 : 0;
+                const unsigned int dv = (dh == 2) ? 1 : 2;
+
+                const auto height_slope = [&](const unsigned int di,
+                                              const unsigned int difference)
+                {
+                  const double L = plane_sums[stencil_side_cell_count * di + 0];
+                  const double C = plane_sums[stencil_side_cell_count * di + 1];
+                  const double R = plane_sums[stencil_side_cell_count * di + 2];
+                  if (difference == 0)
+                    return (L - C) / 3.0;
+                  else if (difference == 1)
+                    return (C - R) / 3.0;
+                  else
+                    return (L - R) / 6.0;
+                };
+
+                for (unsigned int iu = 0; iu < n_differences; ++iu)
+                  for (unsigned int iv = 0; iv < n_differences; ++iv)
+                    {
+                      Tensor<1, dim, double> &candidate = normals[n_candidate_normals_per_dim * dh + n_differences * iu + iv];
+                      candidate[du] = height_slope(du, iu);
+                      candidate[dv] = height_slope(dv, iv);
+                      candidate[dh] = 1.0;
+
+                      if (plane_sums[stencil_side_cell_count * dh + 2] > plane_sums[stencil_side_cell_count * dh + 0])
+                        {
+                          // There is more fluid in in area above the interface on the stencil,
+                          // so flip normal direction
+                          candidate[dh] *= -1.0;
+                        }
+                    }
+              }
+
+            // Add time extrapolated local normal as candidate
+            // this is not expected to be the best candidate in general, but
+            // should result in exact reconstruction for linear interface
+            // translations (see the 2d implementation above)
+            Tensor<1, dim, double> &extrapolated_normal = normals[n_candidate_normals-1];
+            for (unsigned int i=0; i<dim; ++i)
+              extrapolated_normal[i] = solution(local_dof_indices[system_fe
+                                                                  .component_to_system_index(volume_of_fluidN_c_index+i, 0)]);
+
+            // If candidate normal too small, remove from consideration
+            if (extrapolated_normal*extrapolated_normal < volume_fraction_threshold)
+              extrapolated_normal = 0;
+
+            unsigned int index_of_best_normal = 0;
+            {
+              fevalues.reinit(cell);
+              const std::vector<double> weights = fevalues.get_JxW_values();
+
+              double cell_vol = 0.0;
+              for (const double weight : weights)
+                {
+                  cell_vol+=weight;
+                }
+              for (unsigned int nind = 0; nind < n_candidate_normals; ++nind)
+                {
+                  errs[nind] = 0.0;
+                  const double normal_norm = normals[nind].norm_square();
+
+                  if (normal_norm > volume_fraction_threshold) // If candidate normal too small set error to maximum
+                    {
+                      d_vals[nind] = VolumeOfFluid::Utilities::compute_interface_location_newton<dim> (
+                                       max_degree,
+                                       normals[nind],
+                                       cell_volume_of_fluid,
+                                       cell_vol,
+                                       volume_of_fluid_reconstruct_epsilon,
+                                       quadrature.get_points(), weights);
+                    }
+                  else
+                    {
+                      errs[nind] = 27.0;
+                    }
+                }
+            }
+
+            for (unsigned int i = 0; i < n_cells_local_stencil; ++i)
+              {
+                if (neighbor_cells[i] == endc)
+                  {
+                    continue;
+                  }
+
+                fevalues.reinit(neighbor_cells[i]);
+
+                const std::vector<double> weights = fevalues.get_JxW_values();
+
+                double cell_vol = 0.0;
+                for (const double weight : weights)
+                  {
+                    cell_vol+=weight;
+                  }
+
+                for (unsigned int nind = 0; nind < n_candidate_normals; ++nind)
+                  {
+                    const double normal_norm = normals[nind]*normals[nind];
+
+                    if (normal_norm > volume_fraction_threshold) // If candidate normal too small skip as set to max already
+                      {
+                        double dot = 0.0;
+                        for (unsigned int di = 0; di < dim; ++di)
+                          dot += normals[nind][di] * stencil_unit_cell_centers[i][di];
+                        const double n_volume_of_fluid = VolumeOfFluid::Utilities::compute_fluid_volume<dim> (max_degree, normals[nind], d_vals[nind]-dot,
+                                                         quadrature.get_points(), weights)/cell_vol;
+                        const double cell_err = local_volume_of_fluids (i) - n_volume_of_fluid;
+                        errs[nind] += cell_err * cell_err;
+                      }
+                  }
+              }
+
+            for (unsigned int nind = 0; nind < n_candidate_normals; ++nind)
+              {
+                if (errs[index_of_best_normal] >= errs[nind])
+                  index_of_best_normal = nind;
+              }
+
+            normal = normals[index_of_best_normal];
+            d = d_vals[index_of_best_normal];
+          }
+
+        for (unsigned int i=0; i<dim; ++i)
+          initial_solution (local_dof_indices[system_fe
+                                              .component_to_system_index(volume_of_fluidN_c_index+i, 0)]) = normal[i];
+
+        initial_solution (local_dof_indices[system_fe
+                                            .component_to_system_index(volume_of_fluidN_c_index+dim, 0)]) = d;
+
+        for (unsigned int i=0; i<n_volume_of_fluidLS_dofs; ++i)
+          {
+            // Recenter unit cell on origin
+            Tensor<1, dim, double> recentered_support_point = volume_of_fluidLS_var.fe->unit_support_point(i)-reconstruction_stencil_unit_cell_center;
+            initial_solution (local_dof_indices[system_fe
+                                                .component_to_system_index(volume_of_fluidLS_c_index, i)])
+              = d-recentered_support_point*normal;
+          }
+      }
+
+    initial_solution.compress(VectorOperation::insert);
+
+    sim.compute_current_constraints();
+    sim.current_constraints.distribute(initial_solution);
+
+    solution.block(volume_of_fluidN_blockidx) = initial_solution.block(volume_of_fluidN_blockidx);
+    solution.block(volume_of_fluidLS_blockidx) = initial_solution.block(volume_of_fluidLS_blockidx);
   }
 
-  template <>
-  void VolumeOfFluidHandler<2>::update_volume_of_fluid_composition (const typename Simulator<2>::AdvectionField &composition_field,
-                                                                    const VolumeOfFluidField<2> &volume_of_fluid_field,
-                                                                    LinearAlgebra::BlockVector &solution)
+  template <int dim>
+  void VolumeOfFluidHandler<dim>::update_volume_of_fluid_composition (const typename Simulator<dim>::AdvectionField &composition_field,
+                                                                      const VolumeOfFluidField<dim> &volume_of_fluid_field,
+                                                                      LinearAlgebra::BlockVector &solution)
   {
-    const unsigned int dim = 2;
-
     LinearAlgebra::BlockVector initial_solution;
 
     TimerOutput::Scope timer (sim.computing_timer, "Compute VolumeOfFluid compositions");
@@ -507,13 +854,18 @@ namespace aspect
     solution.block(blockidx) = initial_solution.block(blockidx);
   }
 
+}
 
 
-  template <>
-  void VolumeOfFluidHandler<3>::update_volume_of_fluid_composition (const Simulator<3>::AdvectionField &/*composition_field*/,
-                                                                    const VolumeOfFluidField<3> &/*volume_of_fluid_field*/,
-                                                                    LinearAlgebra::BlockVector &/*solution*/)
-  {
-    Assert(false, ExcNotImplemented());
-  }
+
+namespace aspect
+{
+#define INSTANTIATE(dim) \
+  template void VolumeOfFluidHandler<dim>::update_volume_of_fluid_composition (const typename Simulator<dim>::AdvectionField &composition_field, \
+      const VolumeOfFluidField<dim> &volume_of_fluid_field, \
+      LinearAlgebra::BlockVector &solution);
+
+  ASPECT_INSTANTIATE(INSTANTIATE)
+
+#undef INSTANTIATE
 }
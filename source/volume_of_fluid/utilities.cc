@@ -175,7 +175,7 @@ namespace aspect
         const double m12 = nnormal[0]+nnormal[1];
         const double mmin = (m12<nnormal[2])?m12:nnormal[2];
         const double eps = 1e-10;
-        const double v1= (6.0*nnormal[1]*nnormal[2]>eps)
+        const double v1= (6.0*nnormal[1]*nnormal[2]<eps)
                          ?
                          nnormal[0]*nnormal[0]/(eps)
                          :
@@ -278,8 +278,14 @@ namespace aspect
         const double m3 = nnormal[2];
         const double m12 = m1+m2;
 
+        // The formulas below compute the interface location for the
+        // normalized normal vector, relative to the corner of the unit
+        // cell. Shift it to the cell center, and scale it back to the
+        // original normal vector to match the convention of
+        // compute_fluid_fraction().
+
         // Case 1 of Scardovelli and Zaleski
-        const double v1=(6.0*m2*m3>eps)
+        const double v1=(6.0*m2*m3<eps)
                         ?
                         m1*m1/(eps)
                         :
@@ -287,18 +293,18 @@ namespace aspect
 
         if (vol<v1)
           {
-            return -0.5+std::pow(6*mprod*vol, 1./3.);
+            return norm1*(-0.5+std::pow(6*mprod*vol, 1./3.));
           }
 
         // Case 2 of Scardovelli and Zaleski
         const double v2 = v1 + 0.5*(m2-m1)/m3;
         if (vol<v2)
           {
-            return 0.5*(-1+m1+sqrt(m1*m1+8*m2*m3*(vol-v1)));
+            return norm1*0.5*(-1+m1+sqrt(m1*m1+8*m2*m3*(vol-v1)));
           }
 
         // Case 3 of Scardovelli and Zaleski
-        double v3 = (m12<m3)
+        double v3 = (m3<m12)
                     ?
                     m3*m3*(3*m12-m3)/(6.0*mprod)
                     + m1*m1*(m1-3*m3)/(6*mprod)
@@ -315,7 +321,7 @@ namespace aspect
             const double np0 = a2*a2/9.0-a1/3.0;
             const double q0 = (a1*a2-3.0*a0)/6.0-a2*a2*a2/27.0;
             const double theta = acos(q0/sqrt(np0*np0*np0))/3.0;
-            return sqrt(np0)*(sqrt(3.0)*sin(theta)-cos(theta))-a2/3.0;
+            return norm1*(sqrt(np0)*(sqrt(3.0)*sin(theta)-cos(theta))-a2/3.0-0.5);
           }
 
         // Case 4
@@ -324,14 +330,330 @@ namespace aspect
             // Solve appropriate cubic
             double a2 = -1.5;
             double a1 = 1.5*(m1*m1+m2*m2+m3*m3);
-            double a0 = 6*mprod*vol-m1*m1*m1-m2*m2*m2-m3*m3*m3;
+            double a0 = 0.5*(6*mprod*vol-m1*m1*m1-m2*m2*m2-m3*m3*m3);
             double np0 = a2*a2/9.0-a1/3.0;
             double q0 = (a1*a2-3.0*a0)/6.0-a2*a2*a2/27.0;
             double theta = acos(q0/sqrt(np0*np0*np0))/3.0;
-            return sqrt(np0)*(sqrt(3.0)*sin(theta)-cos(theta))-a2/3.0;
+            return norm1*(sqrt(np0)*(sqrt(3.0)*sin(theta)-cos(theta))-a2/3.0-0.5);
           }
 
-        return -0.5+m1*vol+0.5*m12;
+        return norm1*(-0.5+m3*vol+0.5*m12);
+      }
+
+
+
+      namespace
+      {
+        /**
+         * Compute the coefficients of the polynomial computed by
+         * xFEM_Heaviside() in 2d with respect to the basis
+         * $\{1, 2y-1, 2x-1, (2x-1)(2y-1)\}$.
+         */
+        void xFEM_Heaviside_coefficients(const Tensor<1, 2> normal,
+                                         const double d,
+                                         std::vector<double> &coeffs)
+        {
+          const int basis_count=4;
+          coeffs.resize(basis_count);
+
+          const double n_xp = fabs(normal[0]), n_yp = fabs(normal[1]);
+          const double sign_n_x = (((normal[0]) > 0) - ((normal[0]) < 0)),
+                       sign_n_y = (((normal[1]) > 0) - ((normal[1]) < 0));
+
+          const double norm1 = n_xp + n_yp;
+          const double triangle_break = 0.5*fabs(n_xp-n_yp);
+
+          // The formulas below calculate the correct coefficients for a given
+          // basis in order to form a polynomial $f$ which will satisfy $\int
+          // fpdx=\int pH(d-n\cdot x)dx$ for all polynomials $p$ less than or
+          // equal to the given degree
+          //
+          // The functions for the correct values were calculated and exported using sympy
+          if (d<-0.5*norm1)
+            {
+              for (unsigned int i =0; i < basis_count; ++i)
+                coeffs[i] = 0.0;
+            }
+          else if (d>0.5*norm1)
+            {
+              // Full cell
+              coeffs[0] = 1.0;
+              for (unsigned int i =1; i < basis_count; ++i)
+                coeffs[i] = 0.0;
+            }
+          else if (norm1< 1e-7)
+            {
+              coeffs[0] = 0.5;
+              for (unsigned int i =1; i < basis_count; ++i)
+                coeffs[i] = 0.0;
+            }
+          else if (d<=-triangle_break)
+            {
+              //Triangle
+              const double d_n = d + 0.5*norm1;
+              coeffs[0]=0.5*d_n*d_n/(n_xp*n_yp); // 1
+              coeffs[1]=d_n*d_n*(d_n - 1.5*n_yp)/(n_xp*n_yp*n_yp)*sign_n_y; // 2*y - 1
+              coeffs[2]=d_n*d_n*(d_n - 1.5*n_xp)/(n_xp*n_xp*n_yp)*sign_n_x; // 2*x - 1
+              coeffs[3]=1.5*d_n*d_n*(d_n*d_n - 2.0*d_n*n_xp - 2.0*d_n*n_yp + 3.0*n_xp*n_yp)/
+                        (n_xp*n_xp*n_yp*n_yp)*sign_n_x*sign_n_y; // (2*x - 1)*(2*y - 1)
+            }
+          else if (d<triangle_break && n_xp<n_yp)
+            {
+              //Trapezoid X
+              coeffs[0]=(d + 0.5*n_yp)/n_yp; // 1
+              coeffs[1]=0.25*(12.0*d*d + n_xp*n_xp - 3.0*n_yp*n_yp)/(n_yp*n_yp)*sign_n_y; // 2*y - 1
+              coeffs[2]=-0.5*n_xp/n_yp*sign_n_x; // 2*x - 1
+              coeffs[3]=-3.0*d*n_xp/(n_yp*n_yp)*sign_n_x*sign_n_y; // (2*x - 1)*(2*y - 1)
+            }
+          else if (d<triangle_break && n_yp<n_xp)
+            {
+              //Trapezoid Y
+              coeffs[0]=(d + 0.5*n_xp)/n_xp; // 1
+              coeffs[1]=-0.5*n_yp/n_xp*sign_n_y; // 2*y - 1
+              coeffs[2]=0.25*(12.0*pow(d, 2) - 3.0*n_xp*n_xp + n_yp*n_yp)/(n_xp*n_xp)*sign_n_x; // 2*x - 1
+              coeffs[3]=-3.0*d*n_yp/(n_xp*n_xp)*sign_n_x*sign_n_y; // (2*x - 1)*(2*y - 1)
+            }
+          else
+            {
+              //ITriangle
+              const double d_nn = 0.5*norm1-d;
+              coeffs[0]=1.0L-0.5L*d_nn*d_nn/(n_xp*n_yp); // 1
+              coeffs[1]=0.5L*(d_nn*d_nn)*sign_n_y*(2*d_nn - 3*n_yp)/(n_xp*(n_yp*n_yp)); // 2*y - 1
+              coeffs[2]=0.5L*(d_nn*d_nn)*sign_n_x*(2*d_nn - 3*n_xp)/((n_xp*n_xp)*n_yp); // 2*x - 1
+              coeffs[3]=1.5L*(d_nn*d_nn)*sign_n_x*sign_n_y*(-(d_nn*d_nn) + 2*d_nn*n_xp + 2*d_nn*n_yp - 3*n_xp*n_yp)/((n_xp*n_xp)*(n_yp*n_yp)); // (2*x - 1)*(2*y - 1)
+            }
+        }
+
+
+
+        /**
+         * Compute the coefficients of the polynomial computed by
+         * xFEM_Heaviside_derivative_d() in 2d with respect to the basis
+         * $\{1, 2y-1, 2x-1, (2x-1)(2y-1)\}$.
+         */
+        void xFEM_Heaviside_derivative_d_coefficients(const Tensor<1, 2> normal,
+                                                      const double d,
+                                                      std::vector<double> &coeffs)
+        {
+          const int basis_count=4;
+          coeffs.resize(basis_count);
+
+          const double n_xp = fabs(normal[0]), n_yp = fabs(normal[1]);
+          const double sign_n_x = (((normal[0]) > 0) - ((normal[0]) < 0)),
+                       sign_n_y = (((normal[1]) > 0) - ((normal[1]) < 0));
+
+          const double norm1 = n_xp + n_yp;
+          const double triangle_break = 0.5L*fabs(n_xp-n_yp);
+
+          // The formulas below calculate the correct coefficients for a given
+          // basis in order to form a polynomial $f$ which will satisfy $\int
+          // fpdx=\int pH(d-n\cdot x)dx$ for all polynomials $p$ less than or
+          // equal to the given degree
+          //
+          // The functions for the correct values were calculated and exported using sympy
+          if (d<-0.5*norm1)
+            {
+              for (int i =0; i < basis_count; ++i)
+                coeffs[i] = 0.0;
+            }
+          else if (d>0.5*norm1)
+            {
+              // Full cell
+              for (int i =0; i < basis_count; ++i)
+                coeffs[i] = 0.0;
+            }
+          else if (norm1<1e-7)
+            {
+              for (int i =0; i < basis_count; ++i)
+                coeffs[i] = 0.0;
+            }
+          else if (d<=-triangle_break)
+            {
+              //D Triangle
+              const double d_n = d + 0.5*norm1;
+              coeffs[0]=d_n/(n_xp*n_yp); // 1
+              coeffs[1]=3*d_n*sign_n_y*(d_n - n_yp)/(n_xp*(n_yp*n_yp)); // 2*y - 1
+              coeffs[2]=3*d_n*sign_n_x*(d_n - n_xp)/((n_xp*n_xp)*n_yp); // 2*x - 1
+              coeffs[3]=3*d_n*sign_n_x*sign_n_y*(2*(d_n*d_n) - 3*d_n*n_xp - 3*d_n*n_yp + 3*n_xp*n_yp)/((n_xp*n_xp)*(n_yp*n_yp)); // (2*x - 1)*(2*y - 1)
+            }
+          else if (d<triangle_break && n_xp<n_yp)
+            {
+              //D Trapezoid X
+              coeffs[0]=1.0/n_yp; // 1
+              coeffs[1]=6*d*sign_n_y/(n_yp*n_yp); // 2*y - 1
+              coeffs[2]=0; // 2*x - 1
+              coeffs[3]=-3*n_xp*sign_n_x*sign_n_y/(n_yp*n_yp); // (2*x - 1)*(2*y - 1)
+            }
+          else if (d<triangle_break && n_yp<n_xp)
+            {
+              //D Trapezoid Y
+              coeffs[0]=1.0/n_xp; // 1
+              coeffs[1]=0; // 2*y - 1
+              coeffs[2]=6*d*sign_n_x/(n_xp*n_xp); // 2*x - 1
+              coeffs[3]=-3*n_yp*sign_n_x*sign_n_y/(n_xp*n_xp); // (2*x - 1)*(2*y - 1)
+            }
+          else
+            {
+              //D ITriangle
+              const double d_nn = 0.5*norm1-d;
+              coeffs[0]=d_nn/(n_xp*n_yp); // 1
+              coeffs[1]=3*d_nn*sign_n_y*(-d_nn + n_yp)/(n_xp*(n_yp*n_yp)); // 2*y - 1
+              coeffs[2]=3*d_nn*sign_n_x*(-d_nn + n_xp)/((n_xp*n_xp)*n_yp); // 2*x - 1
+              coeffs[3]=3*d_nn*sign_n_x*sign_n_y*(2*(d_nn*d_nn) - 3*d_nn*n_xp - 3*d_nn*n_yp + 3*n_xp*n_yp)/((n_xp*n_xp)*(n_yp*n_yp)); // (2*x - 1)*(2*y - 1)
+            }
+        }
+
+
+
+        /**
+         * Compute the coefficients of the polynomials computed by
+         * xFEM_Heaviside() (or, if @p derivative is true, by
+         * xFEM_Heaviside_derivative_d()) in 3d with respect to the basis
+         * $(2x-1)^a(2y-1)^b(2z-1)^c$ for $a,b,c\in\{0,1\}$, where the
+         * coefficient of each basis function is stored at index $a+2b+4c$.
+         *
+         * The coefficients are computed by integrating the 2d coefficients
+         * of slices of the unit cell normal to the coordinate direction in
+         * which the normal vector has the smallest component. Within each
+         * slice the interface is a line with the same 2d normal vector, and
+         * the 2d coefficients are piecewise polynomials of degree at most 4
+         * in the slice coordinate, with breaks where the shape of the 2d fluid
+         * region changes. Integrating each of these pieces with a 3-point
+         * Gauss rule is therefore exact.
+         */
+        void xFEM_Heaviside_slice_coefficients(const Tensor<1, 3> normal,
+                                               const double d,
+                                               const bool derivative,
+                                               std::vector<double> &coeffs)
+        {
+          const int dim = 3;
+          const int basis_count = 8;
+          coeffs.assign(basis_count, 0.0);
+
+          double norm1 = 0.0;
+          for (unsigned int i = 0; i < dim; ++i)
+            norm1 += std::abs(normal[i]);
+
+          if (d < -0.5*norm1)
+            return;
+          if (d > 0.5*norm1)
+            {
+              // Full cell
+              if (!derivative)
+                coeffs[0] = 1.0;
+              return;
+            }
+          if (norm1 < 1e-7)
+            {
+              if (!derivative)
+                coeffs[0] = 0.5;
+              return;
+            }
+
+          // Choose the slice direction, and the two directions within
+          // each slice
+          unsigned int slice_dir = 0;
+          for (unsigned int i = 1; i < dim; ++i)
+            if (std::abs(normal[i]) < std::abs(normal[slice_dir]))
+              slice_dir = i;
+          const unsigned int x_dir = (slice_dir == 0) ? 1 : 0;
+          const unsigned int y_dir = (slice_dir == 2) ? 1 : 2;
+
+          Tensor<1, 2> slice_normal;
+          slice_normal[0] = normal[x_dir];
+          slice_normal[1] = normal[y_dir];
+          const double n_s = normal[slice_dir];
+
+          // The 2d coefficients change their form where the interface location
+          // within the slice passes these values (see xFEM_Heaviside_coefficients)
+          const double slice_norm1 = std::abs(slice_normal[0]) + std::abs(slice_normal[1]);
+          const double triangle_break = 0.5*std::abs(std::abs(slice_normal[0]) - std::abs(slice_normal[1]));
+          const double slice_breaks[4] = {-0.5*slice_norm1, -triangle_break,
+                                         triangle_break, 0.5*slice_norm1
+                                        };
+
+          std::vector<double> breakpoints = {0.0, 1.0};
+          if (n_s != 0.0)
+            for (const double slice_break : slice_breaks)
+              {
+                const double t = 0.5 + (d - slice_break)/n_s;
+                if (t > 0.0 && t < 1.0)
+                  breakpoints.push_back(t);
+              }
+          std::sort(breakpoints.begin(), breakpoints.end());
+
+          // The exponents of (2x-1) and (2y-1) of the 2d basis functions
+          const unsigned int slice_basis_exponents[4][2] = {{0, 0}, {0, 1}, {1, 0}, {1, 1}};
+
+          const double gauss_points[3] = {0.5-0.5*std::sqrt(0.6), 0.5, 0.5+0.5*std::sqrt(0.6)};
+          const double gauss_weights[3] = {5./18., 8./18., 5./18.};
+
+          std::vector<double> slice_coeffs;
+          for (unsigned int interval = 0; interval + 1 < breakpoints.size(); ++interval)
+            {
+              const double interval_length = breakpoints[interval+1] - breakpoints[interval];
+              for (unsigned int q = 0; q < 3; ++q)
+                {
+                  const double t = breakpoints[interval] + interval_length*gauss_points[q];
+                  const double weight = interval_length*gauss_weights[q];
+
+                  // Interface location within the slice at t
+                  const double slice_d = d - n_s*(t-0.5);
+
+                  if (derivative)
+                    xFEM_Heaviside_derivative_d_coefficients(slice_normal, slice_d, slice_coeffs);
+                  else
+                    xFEM_Heaviside_coefficients(slice_normal, slice_d, slice_coeffs);
+
+                  for (unsigned int k = 0; k < 4; ++k)
+                    {
+                      unsigned int exponents[dim];
+                      exponents[x_dir] = slice_basis_exponents[k][0];
+                      exponents[y_dir] = slice_basis_exponents[k][1];
+
+                      // Basis function constant in the slice direction
+                      exponents[slice_dir] = 0;
+                      coeffs[exponents[0] + 2*exponents[1] + 4*exponents[2]] += weight*slice_coeffs[k];
+
+                      // Basis function linear in the slice direction, which
+                      // is normalized by the integral of (2t-1)^2 = 1/3
+                      exponents[slice_dir] = 1;
+                      coeffs[exponents[0] + 2*exponents[1] + 4*exponents[2]] += 3.0*weight*slice_coeffs[k]*(2.0*t-1.0);
+                    }
+                }
+            }
+        }
+
+
+
+        /**
+         * Evaluate the polynomial with the coefficients computed by
+         * xFEM_Heaviside_slice_coefficients() at the given points, using only
+         * the basis functions up to the given degree.
+         */
+        void evaluate_xFEM_polynomial(const unsigned int degree,
+                                      const std::vector<double> &coeffs,
+                                      const std::vector<Point<3>> &points,
+                                      std::vector<double> &values)
+        {
+          for (unsigned int i = 0; i<points.size(); ++i)
+            {
+              values[i] = coeffs[0];
+              if (degree>=1)
+                {
+                  const double x = 2.0*points[i][0]-1.0,
+                               y = 2.0*points[i][1]-1.0,
+                               z = 2.0*points[i][2]-1.0;
+                  values[i] += coeffs[1]*x +
+                               coeffs[2]*y +
+                               coeffs[3]*x*y +
+                               coeffs[4]*z +
+                               coeffs[5]*x*z +
+                               coeffs[6]*y*z +
+                               coeffs[7]*x*y*z;
+                }
+            }
+        }
       }
 
 
@@ -342,80 +664,13 @@ namespace aspect
                           const std::vector<Point<2>> &points,
                           std::vector<double> &values)
       {
-        const int basis_count=4;
-        std::vector<double> coeffs(basis_count);
-
-        const double n_xp = fabs(normal[0]), n_yp = fabs(normal[1]);
-        const double sign_n_x = (((normal[0]) > 0) - ((normal[0]) < 0)),
-                     sign_n_y = (((normal[1]) > 0) - ((normal[1]) < 0));
-
-        const double norm1 = n_xp + n_yp;
-        const double triangle_break = 0.5*fabs(n_xp-n_yp);
-
         const unsigned int max_degree = 1;
 
         AssertThrow(degree<=max_degree,
                     ExcMessage("Cannot generate xFEM polynomials. Only implemented for degrees<2."));
 
-        // The formulas below calculate the correct coefficients for a given
-        // basis in order to form a polynomial $f$ which will satisfy $\int
-        // fpdx=\int pH(d-n\cdot x)dx$ for all polynomials $p$ less than or
-        // equal to the given degree
-        //
-        // The functions for the correct values were calculated and exported using sympy
-        if (d<-0.5*norm1)
-          {
-            for (unsigned int i =0; i < basis_count; ++i)
-              coeffs[i] = 0.0;
-          }
-        else if (d>0.5*norm1)
-          {
-            // Full cell
-            coeffs[0] = 1.0;
-            for (unsigned int i =1; i < basis_count; ++i)
-              coeffs[i] = 0.0;
-          }
-        else if (norm1< 1e-7)
-          {
-            coeffs[0] = 0.5;
-            for (unsigned int i =1; i < basis_count; ++i)
-              coeffs[i] = 0.0;
-          }
-        else if (d<=-triangle_break)
-          {
-            //Triangle
-            const double d_n = d + 0.5*norm1;
-            coeffs[0]=0.5*d_n*d_n/(n_xp*n_yp); // 1
-            coeffs[1]=d_n*d_n*(d_n - 1.5*n_yp)/(n_xp*n_yp*n_yp)*sign_n_y; // 2*y - 1
-            coeffs[2]=d_n*d_n*(d_n - 1.5*n_xp)/(n_xp*n_xp*n_yp)*sign_n_x; // 2*x - 1
-            coeffs[3]=1.5*d_n*d_n*(d_n*d_n - 2.0*d_n*n_xp - 2.0*d_n*n_yp + 3.0*n_xp*n_yp)/
-                      (n_xp*n_xp*n_yp*n_yp)*sign_n_x*sign_n_y; // (2*x - 1)*(2*y - 1)
-          }
-        else if (d<triangle_break && n_xp<n_yp)
-          {
-            //Trapezoid X
-            coeffs[0]=(d + 0.5*n_yp)/n_yp; // 1
-            coeffs[1]=0.25*(12.0*d*d + n_xp*n_xp - 3.0*n_yp*n_yp)/(n_yp*n_yp)*sign_n_y; // 2*y - 1
-            coeffs[2]=-0.5*n_xp/n_yp*sign_n_x; // 2*x - 1
-            coeffs[3]=-3.0*d*n_xp/(n_yp*n_yp)*sign_n_x*sign_n_y; // (2*x - 1)*(2*y - 1)
-          }
-        else if (d<triangle_break && n_yp<n_xp)
-          {
-            //Trapezoid Y
-            coeffs[0]=(d + 0.5*n_xp)/n_xp; // 1
-            coeffs[1]=-0.5*n_yp/n_xp*sign_n_y; // 2*y - 1
-            coeffs[2]=0.25*(12.0*pow(d, 2) - 3.0*n_xp*n_xp + n_yp*n_yp)/(n_xp*n_xp)*sign_n_x; // 2*x - 1
-            coeffs[3]=-3.0*d*n_yp/(n_xp*n_xp)*sign_n_x*sign_n_y; // (2*x - 1)*(2*y - 1)
-          }
-        else
-          {
-            //ITriangle
-            const double d_nn = 0.5*norm1-d;
-            coeffs[0]=1.0L-0.5L*d_nn*d_nn/(n_xp*n_yp); // 1
-            coeffs[1]=0.5L*(d_nn*d_nn)*sign_n_y*(2*d_nn - 3*n_yp)/(n_xp*(n_yp*n_yp)); // 2*y - 1
-            coeffs[2]=0.5L*(d_nn*d_nn)*sign_n_x*(2*d_nn - 3*n_xp)/((n_xp*n_xp)*n_yp); // 2*x - 1
-            coeffs[3]=1.5L*(d_nn*d_nn)*sign_n_x*sign_n_y*(-(d_nn*d_nn) + 2*d_nn*n_xp + 2*d_nn*n_yp - 3*n_xp*n_yp)/((n_xp*n_xp)*(n_yp*n_yp)); // (2*x - 1)*(2*y - 1)
-          }
+        std::vector<double> coeffs;
+        xFEM_Heaviside_coefficients(normal, d, coeffs);
 
         // Calculate the correct values at the provided quadrature points by
         // multiplying coefficients by the basis polynomials.
@@ -435,13 +690,21 @@ namespace aspect
 
 
 
-      void xFEM_Heaviside(const unsigned int /*degree*/,
-                          const Tensor<1, 3> /*normal*/,
-                          const double /*d*/,
-                          const std::vector<Point<3>> &/*points*/,
-                          std::vector<double> &/*values*/)
+      void xFEM_Heaviside(const unsigned int degree,
+                          const Tensor<1, 3> normal,
+                          const double d,
+                          const std::vector<Point<3>> &points,
+                          std::vector<double> &values)
       {
-        AssertThrow(false, ExcNotImplemented());
+        const unsigned int max_degree = 1;
+
+        AssertThrow(degree<=max_degree,
+                    ExcMessage("Cannot generate xFEM polynomials. Only implemented for degrees<2."));
+
+        std::vector<double> coeffs;
+        xFEM_Heaviside_slice_coefficients(normal, d, false, coeffs);
+
+        evaluate_xFEM_polynomial(degree, coeffs, points, values);
       }
 
 
@@ -452,79 +715,13 @@ namespace aspect
                                        const std::vector<Point<2>> &points,
                                        std::vector<double> &values)
       {
-        const int basis_count=4;
-        std::vector<double> coeffs(basis_count);
-
-        const double n_xp = fabs(normal[0]), n_yp = fabs(normal[1]);
-        const double sign_n_x = (((normal[0]) > 0) - ((normal[0]) < 0)),
-                     sign_n_y = (((normal[1]) > 0) - ((normal[1]) < 0));
-
-        const double norm1 = n_xp + n_yp;
-        const double triangle_break = 0.5L*fabs(n_xp-n_yp);
-
         const int max_degree = 1;
 
         AssertThrow(degree<=max_degree,
                     ExcMessage("Cannot generate xFEM polynomials are only functional for degrees<2."));
 
-
-        // The formulas below calculate the correct coefficients for a given
-        // basis in order to form a polynomial $f$ which will satisfy $\int
-        // fpdx=\int pH(d-n\cdot x)dx$ for all polynomials $p$ less than or
-        // equal to the given degree
-        //
-        // The functions for the correct values were calculated and exported using sympy
-        if (d<-0.5*norm1)
-          {
-            for (int i =0; i < basis_count; ++i)
-              coeffs[i] = 0.0;
-          }
-        else if (d>0.5*norm1)
-          {
-            // Full cell
-            for (int i =0; i < basis_count; ++i)
-              coeffs[i] = 0.0;
-          }
-        else if (norm1<1e-7)
-          {
-            for (int i =0; i < basis_count; ++i)
-              coeffs[i] = 0.0;
-          }
-        else if (d<=-triangle_break)
-          {
-            //D Triangle
-            const double d_n = d + 0.5*norm1;
-            coeffs[0]=d_n/(n_xp*n_yp); // 1
-            coeffs[1]=3*d_n*sign_n_y*(d_n - n_yp)/(n_xp*(n_yp*n_yp)); // 2*y - 1
-            coeffs[2]=3*d_n*sign_n_x*(d_n - n_xp)/((n_xp*n_xp)*n_yp); // 2*x - 1
-            coeffs[3]=3*d_n*sign_n_x*sign_n_y*(2*(d_n*d_n) - 3*d_n*n_xp - 3*d_n*n_yp + 3*n_xp*n_yp)/((n_xp*n_xp)*(n_yp*n_yp)); // (2*x - 1)*(2*y - 1)
-          }
-        else if (d<triangle_break && n_xp<n_yp)
-          {
-            //D Trapezoid X
-            coeffs[0]=1.0/n_yp; // 1
-            coeffs[1]=6*d*sign_n_y/(n_yp*n_yp); // 2*y - 1
-            coeffs[2]=0; // 2*x - 1
-            coeffs[3]=-3*n_xp*sign_n_x*sign_n_y/(n_yp*n_yp); // (2*x - 1)*(2*y - 1)
-          }
-        else if (d<triangle_break && n_yp<n_xp)
-          {
-            //D Trapezoid Y
-            coeffs[0]=1.0/n_xp; // 1
-            coeffs[1]=0; // 2*y - 1
-            coeffs[2]=6*d*sign_n_x/(n_xp*n_xp); // 2*x - 1
-            coeffs[3]=-3*n_yp*sign_n_x*sign_n_y/(n_xp*n_xp); // (2*x - 1)*(2*y - 1)
-          }
-        else
-          {
-            //D ITriangle
-            const double d_nn = 0.5*norm1-d;
-            coeffs[0]=d_nn/(n_xp*n_yp); // 1
-            coeffs[1]=3*d_nn*sign_n_y*(-d_nn + n_yp)/(n_xp*(n_yp*n_yp)); // 2*y - 1
-            coeffs[2]=3*d_nn*sign_n_x*(-d_nn + n_xp)/((n_xp*n_xp)*n_yp); // 2*x - 1
-            coeffs[3]=3*d_nn*sign_n_x*sign_n_y*(2*(d_nn*d_nn) - 3*d_nn*n_xp - 3*d_nn*n_yp + 3*n_xp*n_yp)/((n_xp*n_xp)*(n_yp*n_yp)); // (2*x - 1)*(2*y - 1)
-          }
-
+        std::vector<double> coeffs;
+        xFEM_Heaviside_derivative_d_coefficients(normal, d, coeffs);
 
         // Calculate the correct values at the provided quadrature points by
         // multiplying coefficients by the basis polynomials.
@@ -544,13 +741,21 @@ namespace aspect
 
 
 
-      void xFEM_Heaviside_derivative_d(const unsigned int /*degree*/,
-                                       const Tensor<1, 3> /*normal*/,
-                                       const double /*d*/,
-                                       const std::vector<Point<3>> &/*points*/,
-                                       std::vector<double> &/*values*/)
+      void xFEM_Heaviside_derivative_d(const unsigned int degree,
+                                       const Tensor<1, 3> normal,
+                                       const double d,
+                                       const std::vector<Point<3>> &points,
+                                       std::vector<double> &values)
       {
-        AssertThrow(false, ExcNotImplemented());
+        const unsigned int max_degree = 1;
+
+        AssertThrow(degree<=max_degree,
+                    ExcMessage("Cannot generate xFEM polynomials are only functional for degrees<2."));
+
+        std::vector<double> coeffs;
+        xFEM_Heaviside_slice_coefficients(normal, d, true, coeffs);
+
+        evaluate_xFEM_polynomial(degree, coeffs, points, values);
       }
 
 
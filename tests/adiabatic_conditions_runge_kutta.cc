@@ -0,0 +1,112 @@
+/*
+  Copyright (C) 2026 by the authors of the ASPECT code.
+
+  This file is part of ASPECT.
+
+  ASPECT is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2, or (at your option)
+  any later version.
+
+  ASPECT is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with ASPECT; see the file LICENSE.  If not see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#include <aspect/postprocess/interface.h>
+#include <aspect/simulator_access.h>
+#include <aspect/adiabatic_conditions/interface.h>
+#include <aspect/geometry_model/interface.h>
+#include <aspect/gravity_model/interface.h>
+
+#include <cmath>
+
+
+namespace aspect
+{
+  namespace Postprocess
+  {
+    /**
+     * Compare the adiabatic profile with the exact solution of the
+     * hydrostatic equations for the 'simple' material model with constant
+     * gravity, thermal expansion coefficient and specific heat:
+     *   T(z) = T_0 exp(c z),  with c = alpha g / C_p,
+     *   p(z) = rho_0 g ((1 + alpha T_ref) z - alpha T_0 (exp(c z) - 1) / c).
+     */
+    template <int dim>
+    class AdiabatError : public Interface<dim>, public ::aspect::SimulatorAccess<dim>
+    {
+      public:
+        std::pair<std::string,std::string>
+        execute (TableHandler &statistics) override;
+    };
+
+
+
+    template <int dim>
+    std::pair<std::string,std::string>
+    AdiabatError<dim>::execute (TableHandler &)
+    {
+      // these values need to match the ones in the input file
+      const double reference_density = 3300;
+      const double reference_temperature = 1600;
+      const double thermal_expansivity = 3e-5;
+      const double specific_heat = 1250;
+      const unsigned int n_points = 1000;
+
+      const double maximal_depth = this->get_geometry_model().maximal_depth();
+      const double surface_temperature = this->get_adiabatic_surface_temperature();
+      const double gravity = this->get_gravity_model().gravity_vector(this->get_geometry_model().representative_point(0)).norm();
+      const double c = thermal_expansivity * gravity / specific_heat;
+
+      const auto exact_temperature = [&] (const double z)
+      {
+        return surface_temperature * std::exp(c * z);
+      };
+      const auto exact_pressure = [&] (const double z)
+      {
+        return reference_density * gravity
+               * ((1. + thermal_expansivity * reference_temperature) * z
+                  - thermal_expansivity * surface_temperature * (std::exp(c * z) - 1.) / c);
+      };
+
+      // compare at the points of the table of the profile, where the
+      // adiabatic conditions do not interpolate
+      double temperature_error = 0;
+      double pressure_error = 0;
+      for (unsigned int i=0; i<n_points; ++i)
+        {
+          const double z = maximal_depth * i / (n_points-1);
+          const Point<dim> p = this->get_geometry_model().representative_point(z);
+
+          temperature_error = std::max (temperature_error,
+                                        std::abs(this->get_adiabatic_conditions().temperature(p) - exact_temperature(z))
+                                        / exact_temperature(z));
+          pressure_error = std::max (pressure_error,
+                                     std::abs(this->get_adiabatic_conditions().pressure(p) - exact_pressure(z))
+                                     / exact_pressure(maximal_depth));
+        }
+
+      return std::make_pair ("Adiabat errors below 1e-8:",
+                             (temperature_error < 1e-8 && pressure_error < 1e-8) ? "yes" : "no");
+    }
+  }
+}
+
+
+// explicit instantiations
+namespace aspect
+{
+  namespace Postprocess
+  {
+    ASPECT_REGISTER_POSTPROCESSOR(AdiabatError,
+                                  "adiabat error",
+                                  "A postprocessor that compares the adiabatic profile "
+                                  "with the exact solution for constant material properties.")
+  }
+}
@@ -0,0 +1,9 @@
+#!/bin/bash
+
+# Only keep the time step sizes. The statistics of this model are
+# compared with the subcycled models in their own scripts.
+if [ "$1" == "screen-output" ]; then
+  grep -E "^\*\*\* Timestep"
+else
+  cat
+fi
@@ -0,0 +1,46 @@
+#!/bin/bash
+
+# Keep the time step sizes, and compare the temperature
+# statistics at the end of every time step with the statistics of the
+# model without subcycling at the same time.
+if [ "$1" == "screen-output" ]; then
+  grep -E "^\*\*\* Timestep"
+  awk -v quantities="Minimal temperature (K),Average temperature (K),Maximal temperature (K)" '
+  BEGIN { n = split(quantities, quantity, ",") }
+  function abs(v) { return v < 0 ? -v : v }
+  /^# [0-9]+: / {
+    c = $2; sub(":", "", c)
+    column[FILENAME, substr($0, index($0, ": ") + 2)] = c
+    next
+  }
+  !/^#/ && NF > 0 {
+    t = $column[FILENAME, "Time (seconds)"] + 0
+    for (i = 1; i <= n; ++i)
+      value[FILENAME, t, quantity[i]] = $column[FILENAME, quantity[i]]
+    if (FILENAME == ARGV[2])
+      times[t] = 1
+  }
+  END {
+    for (t in times)
+      {
+        if (t == 0)
+          continue
+        match_reference = "yes"
+        for (i = 1; i <= n; ++i)
+          {
+            if (!((ARGV[1], t, quantity[i]) in value))
+              match_reference = "no"
+            else
+              {
+                a = value[ARGV[2], t, quantity[i]]
+                b = value[ARGV[1], t, quantity[i]]
+                if (abs(a - b) > 1e-2 * (1 + abs(b)))
+                  match_reference = "no"
+              }
+          }
+        print "Statistics at t=" t " match the model without subcycling: " match_reference
+      }
+  }' output-advection_subcycling_no_subcycling/statistics output-advection_subcycling_particles/statistics | sort
+else
+  cat
+fi
@@ -0,0 +1,44 @@
+/*
+  Copyright (C) 2026 by the authors of the ASPECT code.
+
+  This file is part of ASPECT.
+
+  ASPECT is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2, or (at your option)
+  any later version.
+
+  ASPECT is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with ASPECT; see the file LICENSE.  If not see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#include <aspect/simulator.h>
+#include <iostream>
+
+/*
+ * Launch the following function when this plugin is created. Create a
+ * directory in the place of the file that the background thread writes the
+ * serialized state into, so that writing the checkpoint fails on that thread.
+ */
+int f()
+{
+  std::cout << "* Blocking the resume file of the checkpoint." << std::endl;
+
+  const int ret = system ("mkdir -p output-checkpoint_background_writer_error/restart.resume.z.new");
+  if (ret!=0)
+    {
+      std::cout << "system() returned error " << ret << std::endl;
+      exit(1);
+    }
+
+  return 42;
+}
+
+// run this function by initializing a global variable by it
+int i = f();
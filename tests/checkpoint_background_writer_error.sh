@@ -0,0 +1,12 @@
+#!/bin/bash
+
+# The error message is wrapped differently depending on the length of
+# the output path, so only check that the snapshot was written in the
+# background and that the error of the background thread was reported.
+if [ "$1" == "screen-output" ]; then
+  tr -s '[:space:]' ' ' > output-checkpoint_background_writer_error/screen-output.joined
+  echo "Snapshot written in the background: $(grep -q 'writing it to disk in the background' output-checkpoint_background_writer_error/screen-output.joined && echo yes || echo no)"
+  echo "Error reported: $(grep -q "Writing of the checkpoint file '[^']*restart.resume.z.new' with size [0-9]* failed on processor 0" output-checkpoint_background_writer_error/screen-output.joined && echo yes || echo no)"
+else
+  cat
+fi
@@ -0,0 +1,55 @@
+/*
+  Copyright (C) 2026 by the authors of the ASPECT code.
+
+  This file is part of ASPECT.
+
+  ASPECT is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2, or (at your option)
+  any later version.
+
+  ASPECT is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with ASPECT; see the file LICENSE.  If not see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#include <aspect/simulator.h>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+
+/*
+ * Launch the following function when this plugin is created. Write restart
+ * files into the output directory whose resume file starts with the correct
+ * identifier, but claims to use a version of the format that does not exist.
+ * The mesh file is only checked for existence before the resume file is read.
+ */
+int f()
+{
+  std::cout << "* Writing restart files with an unknown format version." << std::endl;
+
+  const int ret = system ("mkdir -p output-checkpoint_resume_file_version");
+  if (ret!=0)
+    {
+      std::cout << "system() returned error " << ret << std::endl;
+      exit(1);
+    }
+
+  std::ofstream mesh ("output-checkpoint_resume_file_version/restart.mesh");
+
+  const std::string identifier = "ASPECT resume file";
+  const std::uint32_t version = 99;
+  std::ofstream resume ("output-checkpoint_resume_file_version/restart.resume.z", std::ios::binary);
+  resume.write (identifier.data(), identifier.size());
+  resume.write (reinterpret_cast<const char *>(&version), sizeof(version));
+
+  return 42;
+}
+
+// run this function by initializing a global variable by it
+int i = f();
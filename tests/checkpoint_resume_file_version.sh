@@ -0,0 +1,10 @@
+#!/bin/bash
+
+# The error message is wrapped differently depending on the length of
+# the output path, so only check that it names both versions.
+if [ "$1" == "screen-output" ]; then
+  tr -s '[:space:]' ' ' > output-checkpoint_resume_file_version/screen-output.joined
+  echo "Error reported: $(grep -q 'was written in version 99 of the format of this file, but this version of ASPECT can only read version' output-checkpoint_resume_file_version/screen-output.joined && echo yes || echo no)"
+else
+  cat
+fi
@@ -0,0 +1,32 @@
+#!/bin/bash
+
+# Replace the screen output by a check of the relations between the
+# compositional fields in all time steps of the statistics file.
+
+cat > /dev/null
+awk '
+BEGIN { scaled = "yes"; identical = "yes"; n_steps = 0 }
+function abs(v) { return v < 0 ? -v : v }
+function close_to(a, b) { return abs(a - b) <= 1e-6 * (1 + abs(b)) }
+/^# [0-9]+: / {
+  n = $2; sub(":", "", n)
+  column[substr($0, index($0, ": ") + 2)] = n
+  next
+}
+!/^#/ && NF > 0 {
+  ++n_steps
+  split("Minimal value,Maximal value,Global mass", quantities, ",")
+  for (i = 1; i <= 3; ++i)
+    {
+      c1 = $column[quantities[i] " for composition C_1"]
+      c2 = $column[quantities[i] " for composition C_2"]
+      c3 = $column[quantities[i] " for composition C_3"]
+      if (!close_to(c2, 2 * c1 + 1)) scaled = "no"
+      if (!close_to(c3, c1)) identical = "no"
+    }
+}
+END {
+  print "More than one time step: " (n_steps > 1 ? "yes" : "no")
+  print "C_2 = 2*C_1+1 in all time steps: " scaled
+  print "C_3 = C_1 in all time steps: " identical
+}' output-entropy_viscosity_statistics_fields/statistics
@@ -0,0 +1,13 @@
+#!/bin/bash
+
+# The number of time steps depends on the details of the error estimate,
+# so only check that time steps were repeated and that the model still
+# reached the end time.
+if [ "$1" == "screen-output" ]; then
+  awk '/^Repeating the current time step/ { repeated = 1 }
+       /^\*\*\* Timestep/ { t = $4; sub("t=", "", t) }
+       END { print "Time steps were repeated: " (repeated ? "yes" : "no");
+             print "Reached the end time: " (t == 0.5 ? "yes" : "no") }'
+else
+  cat
+fi
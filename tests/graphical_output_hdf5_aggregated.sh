@@ -0,0 +1,10 @@
+#!/bin/bash
+
+# The write bandwidth depends on the machine, so replace the screen
+# output by a check that the statistics file contains its column.
+if [ "$1" == "screen-output" ]; then
+  cat > /dev/null
+  echo "Column Visualization write bandwidth (MB/s) exists: $(grep -q '^# [0-9]*: Visualization write bandwidth (MB/s)$' output-graphical_output_hdf5_aggregated/statistics && echo yes || echo no)"
+else
+  cat
+fi
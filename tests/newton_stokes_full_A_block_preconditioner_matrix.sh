@@ -0,0 +1,15 @@
+#!/bin/bash
+
+# Only keep the number of nonzero entries of the velocity and pressure
+# blocks of the preconditioner matrix. The velocity block may only
+# contain diagonal entries, so compare it with the number of velocity
+# degrees of freedom. Numbers are printed with thousands separators.
+if [ "$1" == "screen-output" ]; then
+  sed -e 's/,//g' | awk '/^Number of degrees of freedom:/ { split($7, n, "[(+]"); velocity_dofs = n[2] }
+       /^system preconditioner matrix nnz by block:/ { row = 1; next }
+       row == 1 { velocity_nnz = $1; row = 2; next }
+       row == 2 { print "Preconditioner matrix pressure block nnz: " $2; row = 0 }
+       END { print "Preconditioner matrix velocity block is at most diagonal: " (velocity_nnz <= velocity_dofs ? "yes" : "no") }'
+else
+  cat
+fi
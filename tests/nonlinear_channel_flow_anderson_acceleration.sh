@@ -0,0 +1,21 @@
+#!/bin/bash
+
+# Only keep the velocity and mass flux statistics, and replace the
+# nonlinear residuals by a check that the nonlinear solver converged in
+# fewer iterations than the 11 that it needs without acceleration.
+
+if [ "$1" == "screen-output" ]; then
+  awk '
+/Relative nonlinear residual \(total system\) after nonlinear iteration/ {
+  n_iterations = $(NF-1); sub(":", "", n_iterations)
+  residual = $NF
+  next
+}
+/RMS, max velocity|Mass fluxes through boundary parts/ { print }
+END {
+  print "Nonlinear solver converged: " (residual < 1e-8 ? "yes" : "no")
+  print "Fewer nonlinear iterations than without acceleration: " (n_iterations < 11 ? "yes" : "no")
+}'
+else
+  cat
+fi
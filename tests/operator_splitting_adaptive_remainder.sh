@@ -0,0 +1,23 @@
+#!/bin/bash
+
+# Replace the screen output by a check of the compositional fields in the
+# statistics file: In time step n, the minimum of C_1 has to be exp(-n),
+# its maximum 1, the minimum of C_2 0 and its maximum 1-exp(-n).
+
+cat > /dev/null
+awk '
+function abs(v) { return v < 0 ? -v : v }
+function close_to(a, b) { return abs(a - b) <= 1e-4 }
+/^# [0-9]+: / {
+  n = $2; sub(":", "", n)
+  column[substr($0, index($0, ": ") + 2)] = n
+  next
+}
+!/^#/ && NF > 0 {
+  decay = exp(-$1)
+  correct = (close_to($column["Minimal value for composition C_1"], decay) \
+             && close_to($column["Maximal value for composition C_1"], 1) \
+             && close_to($column["Minimal value for composition C_2"], 0) \
+             && close_to($column["Maximal value for composition C_2"], 1 - decay))
+  print "Time step " $1 ": reactions " (correct ? "correct" : "wrong")
+}' output-operator_splitting_adaptive_remainder/statistics
@@ -0,0 +1,22 @@
+#!/bin/bash
+
+# Replace the screen output by the particles of the last output file,
+# as read by the reader script for the 'columnar' format, and check that
+# all values are bitwise identical to the particles of the unfused
+# integration.
+
+cat > /dev/null
+scripts=`dirname $0`/../contrib/python/scripts
+python3 $scripts/read_columnar_particles.py output-particle_integrator_rk4_fused/particles/particles-00002.columns
+python3 - $scripts output-particle_integrator_rk4_fused/particles/particles-00002.columns output-particle_integrator_rk4_unfused/particles/particles-00002.columns <<'PYTHON'
+import sys
+sys.path.insert(0, sys.argv[1])
+from read_columnar_particles import read_columnar_particles
+
+def sorted_particles(fname):
+    header, column_names, data = read_columnar_particles(fname)
+    return sorted(zip(*[data[name] for name in column_names]))
+
+identical = (sorted_particles(sys.argv[2]) == sorted_particles(sys.argv[3]))
+print('Particles identical to the unfused integration: ' + ('yes' if identical else 'no'))
+PYTHON
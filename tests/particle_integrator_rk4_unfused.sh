@@ -0,0 +1,7 @@
+#!/bin/bash
+
+# Replace the screen output by the particles of the last output file,
+# as read by the reader script for the 'columnar' format.
+
+cat > /dev/null
+python3 `dirname $0`/../contrib/python/scripts/read_columnar_particles.py output-particle_integrator_rk4_unfused/particles/particles-00002.columns
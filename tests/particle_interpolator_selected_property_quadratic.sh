@@ -0,0 +1,29 @@
+#!/bin/bash
+
+# Replace the screen output by a comparison of the statistics of the
+# compositional field interpolated from the particles (C_1) with the
+# statistics of the static field with the same values (C_2).
+
+cat > /dev/null
+awk '
+BEGIN { n_steps = 0; identical = "yes" }
+function abs(v) { return v < 0 ? -v : v }
+/^# [0-9]+: / {
+  n = $2; sub(":", "", n)
+  column[substr($0, index($0, ": ") + 2)] = n
+  next
+}
+!/^#/ && NF > 0 {
+  ++n_steps
+  split("Minimal value,Maximal value,Global mass", quantities, ",")
+  for (i = 1; i <= 3; ++i)
+    {
+      c1 = $column[quantities[i] " for composition C_1"]
+      c2 = $column[quantities[i] " for composition C_2"]
+      if (abs(c1 - c2) > 1e-8 * (1 + abs(c2))) identical = "no"
+    }
+}
+END {
+  print "Time steps: " n_steps
+  print "C_1 = C_2 in all time steps: " identical
+}' output-particle_interpolator_selected_property_quadratic/statistics
@@ -0,0 +1,26 @@
+#!/bin/bash
+
+# The measured particle weight depends on run times, so replace the
+# screen output by a check that the load balance statistics contain the
+# columns for the measured weight and that their values are sensible.
+
+cat > /dev/null
+awk '
+BEGIN { n_steps = 0; positive = "yes"; ratio_valid = "yes" }
+/^# [0-9]+: / {
+  n = $2; sub(":", "", n)
+  column[substr($0, index($0, ": ") + 2)] = n
+  next
+}
+!/^#/ && NF > 0 {
+  ++n_steps
+  if (("Particle weight" in column) && $column["Particle weight"] <= 0) positive = "no"
+  if (("Maximal to average weighted load ratio" in column) && $column["Maximal to average weighted load ratio"] < 1 - 1e-12) ratio_valid = "no"
+}
+END {
+  print "More than one time step: " (n_steps > 1 ? "yes" : "no")
+  print "Column Particle weight exists: " (("Particle weight" in column) ? "yes" : "no")
+  print "Column Maximal to average weighted load ratio exists: " (("Maximal to average weighted load ratio" in column) ? "yes" : "no")
+  print "Particle weight positive in all time steps: " positive
+  print "Weighted load ratio at least one in all time steps: " ratio_valid
+}' output-particle_measure_weight/statistics
@@ -0,0 +1,9 @@
+#!/bin/bash
+
+# Only keep the time steps and the number of particles, which is
+# what this test checks.
+if [ "$1" == "screen-output" ]; then
+  grep -E "^\*\*\* Timestep|Number of advected particles"
+else
+  cat
+fi
@@ -0,0 +1,9 @@
+#!/bin/bash
+
+# Replace the screen output by the number of rebuilds and reuses of the
+# Stokes preconditioner in each time step, taken from the statistics file.
+
+cat > /dev/null
+awk '/^# [0-9]+: / { n = $2; sub(":", "", n); column[substr($0, index($0, ": ") + 2)] = n; next }
+     !/^#/ && NF > 0 { print "Time step " $1 ": " $column["Stokes preconditioner rebuilds"] " rebuilds, " $column["Stokes preconditioner reuses"] " reuses" }' \
+    output-stokes_preconditioner_adaptive_rebuild/statistics
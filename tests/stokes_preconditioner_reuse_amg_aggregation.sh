@@ -0,0 +1,9 @@
+#!/bin/bash
+
+# Only keep the time steps, how the Stokes preconditioner was built, and
+# the velocity, which is what this test checks.
+if [ "$1" == "screen-output" ]; then
+  grep -E "^\*\*\* Timestep|Rebuilding Stokes preconditioner|RMS, max velocity" | sed -e 's/  */ /g'
+else
+  cat
+fi
@@ -0,0 +1,35 @@
+# This file was generated by the deal.II library.
+
+
+#
+# For a description of the GNUPLOT format see the GNUPLOT manual.
+#
+# <x> <y> <velocity> <velocity> <p> <T> 
+0 0 0 0 0 0 
+0.125 0 0 0 0 0.125 
+
+0 0.125 0 0 0 0 
+0.125 0.125 0 0 0 0.125 
+
+
+0.125 0 0 0 0 0.125 
+0.25 0 0 0 0 0.25 
+
+0.125 0.125 0 0 0 0.125 
+0.25 0.125 0 0 0 0.25 
+
+
+0 0.125 0 0 0 0 
+0.125 0.125 0 0 0 0.125 
+
+0 0.25 0 0 0 0 
+0.125 0.25 0 0 0 0.125 
+
+
+0.125 0.125 0 0 0 0.125 
+0.25 0.125 0 0 0 0.25 
+
+0.125 0.25 0 0 0 0.125 
+0.25 0.25 0 0 0 0.25 
+
+
@@ -0,0 +1,63 @@
+# This file was generated by the deal.II library.
+
+
+#
+# For a description of the GNUPLOT format see the GNUPLOT manual.
+#
+# <x> <y> <velocity> <velocity> <p> <T> 
+0 0.875 0 0 0 0 
+0.125 0.875 0 0 0 0.125 
+
+0 1 0 0 0 0 
+0.125 1 0 0 0 0.125 
+
+
+0.125 0.875 0 0 0 0.125 
+0.25 0.875 0 0 0 0.25 
+
+0.125 1 0 0 0 0.125 
+0.25 1 0 0 0 0.25 
+
+
+0.25 0.875 0 0 0 0.25 
+0.375 0.875 0 0 0 0.375 
+
+0.25 1 0 0 0 0.25 
+0.375 1 0 0 0 0.375 
+
+
+0.375 0.875 0 0 0 0.375 
+0.5 0.875 0 0 0 0.5 
+
+0.375 1 0 0 0 0.375 
+0.5 1 0 0 0 0.5 
+
+
+0.5 0.875 0 0 0 0.5 
+0.625 0.875 0 0 0 0.625 
+
+0.5 1 0 0 0 0.5 
+0.625 1 0 0 0 0.625 
+
+
+0.625 0.875 0 0 0 0.625 
+0.75 0.875 0 0 0 0.75 
+
+0.625 1 0 0 0 0.625 
+0.75 1 0 0 0 0.75 
+
+
+0.75 0.875 0 0 0 0.75 
+0.875 0.875 0 0 0 0.875 
+
+0.75 1 0 0 0 0.75 
+0.875 1 0 0 0 0.875 
+
+
+0.875 0.875 0 0 0 0.875 
+1 0.875 0 0 0 1 
+
+0.875 1 0 0 0 0.875 
+1 1 0 0 0 1 
+
+
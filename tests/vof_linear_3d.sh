@@ -0,0 +1,8 @@
+#!/bin/bash
+
+# Replace the screen output by the time step number, time, time step
+# size, and volume of fluid of each time step from the statistics file,
+# which is what this test checks.
+
+cat > /dev/null
+awk '!/^#/ && NF > 0 {print $1, $2, $3, $NF}' output-vof_linear_3d/statistics